@@ -33,6 +33,7 @@
 #include "llvm/Support/CommandLine.h"
 #include "Lonestar/BoilerPlate.h"
 #include "Galois/Graph/GraphNodeBag.h"
+#include "Galois/WorkList/SchedulerRegistry.h"
 #include "HybridBFS.h"
 
 #include GALOIS_CXX11_STD_HEADER(atomic)
@@ -172,7 +173,7 @@ struct AsyncAlgo {
     typedef Galois::WorkList::GlobPQ<WorkItem, Galois::WorkList::MultiQueue<Comparer, WorkItem, 4>> MQ4;
     typedef Galois::WorkList::GlobPQ<WorkItem, Galois::WorkList::DistQueue<Comparer, WorkItem, false>> PTSL;
     typedef Galois::WorkList::GlobPQ<WorkItem, Galois::WorkList::DistQueue<Comparer, WorkItem, true>> PPSL;
-    typedef Galois::WorkList::GlobPQ<WorkItem, Galois::WorkList::LocalPQ<Comparer, WorkItem>> LPQ;
+    typedef Galois::WorkList::GlobPQ<WorkItem, Galois::WorkList::LocalPQ<Comparer, WorkItem, false>> LPQ;
     typedef Galois::WorkList::GlobPQ<WorkItem, Galois::WorkList::SwarmPQ<Comparer, WorkItem>> SWARMPQ;
     typedef Galois::WorkList::GlobPQ<WorkItem, Galois::WorkList::PartitionPQ<Comparer, Hasher, WorkItem>> PPQ;
 
@@ -274,15 +275,7 @@ struct AsyncAlgo {
       }
     };
 
-    typedef Galois::WorkList::OrderedByIntegerMetric<Indexer,Galois::WorkList::dChunkedFIFO<ChunkSize> > OBIM;
-    typedef Galois::WorkList::GlobPQ<GNode, Galois::WorkList::LockFreeSkipList<Comparer, GNode>> GPQ;
-    typedef Galois::WorkList::GlobPQ<GNode, Galois::WorkList::SprayList<NodeComparer, GNode>> SL;
-    typedef Galois::WorkList::GlobPQ<GNode, Galois::WorkList::MultiQueue<Comparer, GNode, 4>> MQ4;
-    typedef Galois::WorkList::GlobPQ<GNode, Galois::WorkList::DistQueue<Comparer, GNode, false>> PTSL;
-    typedef Galois::WorkList::GlobPQ<GNode, Galois::WorkList::DistQueue<Comparer, GNode, true>> PPSL;
-    typedef Galois::WorkList::GlobPQ<GNode, Galois::WorkList::LocalPQ<Comparer, GNode>> LPQ;
-    typedef Galois::WorkList::GlobPQ<GNode, Galois::WorkList::SwarmPQ<Comparer, GNode>> SWARMPQ;
-    typedef Galois::WorkList::GlobPQ<GNode, Galois::WorkList::PartitionPQ<Comparer, Hasher, GNode>> PPQ;
+    typedef Galois::WorkList::SchedulerTraits<GNode, Indexer, Comparer, NodeComparer, Hasher, ChunkSize> Traits;
 
     Graph& g;
     CountPaths(Graph& g) :g(g) { Indexer::g = &g; Comparer::g = &g; NodeComparer::g = &g; }
@@ -357,15 +350,7 @@ struct AsyncAlgo {
     };
 
 
-    typedef Galois::WorkList::OrderedByIntegerMetric<Indexer,Galois::WorkList::dChunkedFIFO<ChunkSize> > OBIM;
-    typedef Galois::WorkList::GlobPQ<GNode, Galois::WorkList::LockFreeSkipList<Comparer, GNode>> GPQ;
-    typedef Galois::WorkList::GlobPQ<GNode, Galois::WorkList::SprayList<NodeComparer, GNode>> SL;
-    typedef Galois::WorkList::GlobPQ<GNode, Galois::WorkList::MultiQueue<Comparer, GNode, 4>> MQ4;
-    typedef Galois::WorkList::GlobPQ<GNode, Galois::WorkList::DistQueue<Comparer, GNode, false>> PTSL;
-    typedef Galois::WorkList::GlobPQ<GNode, Galois::WorkList::DistQueue<Comparer, GNode, true>> PPSL;
-    typedef Galois::WorkList::GlobPQ<GNode, Galois::WorkList::LocalPQ<Comparer, GNode>> LPQ;
-    typedef Galois::WorkList::GlobPQ<GNode, Galois::WorkList::SwarmPQ<Comparer, GNode>> SWARMPQ;
-    typedef Galois::WorkList::GlobPQ<GNode, Galois::WorkList::PartitionPQ<Comparer, Hasher, GNode>> PPQ;
+    typedef Galois::WorkList::SchedulerTraits<GNode, Indexer, Comparer, NodeComparer, Hasher, ChunkSize> Traits;
 
     Graph& g;
     ComputeDep(Graph& g) :g(g) { Indexer::g = &g; Comparer::g = &g; NodeComparer::g = &g; }
@@ -397,6 +382,25 @@ struct AsyncAlgo {
     }
   };
 
+  struct RunCount {
+    Graph& graph;
+    RunCount(Graph& g): graph(g) { }
+    template<typename S>
+    void operator()(S) {
+      Galois::for_each_local(graph, CountPaths(graph), Galois::loopname("COUNT"), Galois::wl<typename S::type>());
+    }
+  };
+
+  struct RunDep {
+    Graph& graph;
+    RunDep(Graph& g): graph(g) { }
+    template<typename S>
+    void operator()(S) {
+      Galois::for_each(graph.begin(), graph.end(), ComputeDep(graph), Galois::loopname("DEP"), Galois::wl<typename S::type>());
+    }
+  };
+
+
   void operator()(Graph& graph, GNode source) {
     Galois::StatTimer Tinit("InitTime"), Tlevel("LevelTime"), Tbfs("BFSTime"), Tcount("CountTime"), Tdep("DepTime");
     Tinit.start();
@@ -412,51 +416,16 @@ struct AsyncAlgo {
     std::cout << "BFS DONE " << Tbfs.get() << "\n";
     Tcount.start();
     graph.getData(source).numPaths = 1;
-    std::string wl = worklistname;
-    if (wl == "obim")
-      Galois::for_each_local(graph, CountPaths(graph), Galois::loopname("COUNT"), Galois::wl<CountPaths::OBIM>());
-    else if (wl == "skiplist")
-      Galois::for_each_local(graph, CountPaths(graph), Galois::loopname("COUNT"), Galois::wl<CountPaths::GPQ>());
-    else if (wl == "spraylist")
-      Galois::for_each_local(graph, CountPaths(graph), Galois::loopname("COUNT"), Galois::wl<CountPaths::SL>());
-    else if (wl == "multiqueue4")
-      Galois::for_each_local(graph, CountPaths(graph), Galois::loopname("COUNT"), Galois::wl<CountPaths::MQ4>());
-    else if (wl == "thrskiplist")
-      Galois::for_each_local(graph, CountPaths(graph), Galois::loopname("COUNT"), Galois::wl<CountPaths::PTSL>());
-    else if (wl == "pkgskiplist")
-      Galois::for_each_local(graph, CountPaths(graph), Galois::loopname("COUNT"), Galois::wl<CountPaths::PPSL>());
-    else if (wl == "lpq")
-      Galois::for_each_local(graph, CountPaths(graph), Galois::loopname("COUNT"), Galois::wl<CountPaths::LPQ>());
-    else if (wl == "swarm")
-      Galois::for_each_local(graph, CountPaths(graph), Galois::loopname("COUNT"), Galois::wl<CountPaths::SWARMPQ>());
-    else if (wl == "ppq")
-      Galois::for_each_local(graph, CountPaths(graph), Galois::loopname("COUNT"), Galois::wl<CountPaths::PPQ>());
-    else
-      std::cerr << "No work list!" << "\n";
+    RunCount count(graph);
+    if (!Galois::WorkList::SchedulerRegistry<CountPaths::Traits>::run(worklistname, count))
+      Galois::WorkList::SchedulerRegistry<CountPaths::Traits>::printNames(std::cerr << "No work list! Choose one of:") << "\n";
     Tcount.stop();
     std::cout << "COUNT DONE " << Tcount.get() << "\n";
     Tdep.start();
     graph.getData(source).dependencies = 0.0;
-    if (wl == "obim")
-      Galois::for_each(graph.begin(), graph.end(), ComputeDep(graph), Galois::loopname("DEP"), Galois::wl<ComputeDep::OBIM>());
-    else if (wl == "skiplist")
-      Galois::for_each(graph.begin(), graph.end(), ComputeDep(graph), Galois::loopname("DEP"), Galois::wl<ComputeDep::GPQ>());
-    else if (wl == "spraylist")
-      Galois::for_each(graph.begin(), graph.end(), ComputeDep(graph), Galois::loopname("DEP"), Galois::wl<ComputeDep::SL>());
-    else if (wl == "multiqueue4")
-      Galois::for_each(graph.begin(), graph.end(), ComputeDep(graph), Galois::loopname("DEP"), Galois::wl<ComputeDep::MQ4>());
-    else if (wl == "thrskiplist")
-      Galois::for_each(graph.begin(), graph.end(), ComputeDep(graph), Galois::loopname("DEP"), Galois::wl<ComputeDep::PTSL>());
-    else if (wl == "pkgskiplist")
-      Galois::for_each(graph.begin(), graph.end(), ComputeDep(graph), Galois::loopname("DEP"), Galois::wl<ComputeDep::PPSL>());
-    else if (wl == "lpq")
-      Galois::for_each(graph.begin(), graph.end(), ComputeDep(graph), Galois::loopname("DEP"), Galois::wl<ComputeDep::LPQ>());
-    else if (wl == "swarm")
-      Galois::for_each(graph.begin(), graph.end(), ComputeDep(graph), Galois::loopname("DEP"), Galois::wl<ComputeDep::SWARMPQ>());
-    else if (wl == "ppq")
-      Galois::for_each(graph.begin(), graph.end(), ComputeDep(graph), Galois::loopname("DEP"), Galois::wl<ComputeDep::PPQ>());
-    else
-      std::cerr << "No work list!" << "\n";
+    RunDep dep(graph);
+    if (!Galois::WorkList::SchedulerRegistry<ComputeDep::Traits>::run(worklistname, dep))
+      Galois::WorkList::SchedulerRegistry<ComputeDep::Traits>::printNames(std::cerr << "No work list! Choose one of:") << "\n";
     Tdep.stop();
     std::cout << "DEP DONE " << Tdep.get() << "\n";
   }
@@ -33,6 +33,7 @@
 #include "Galois/Graph/LCGraph.h"
 #include "Galois/Graph/TypeTraits.h"
 #include "Galois/ParallelSTL/ParallelSTL.h"
+#include "Galois/WorkList/SchedulerRegistry.h"
 #ifdef GALOIS_USE_EXP
 #include "Galois/Runtime/ParallelWorkInline.h"
 #endif
@@ -382,151 +383,29 @@ struct AsyncAlgo {
     }
   };
 
-  void operator()(Graph& graph, const GNode& source) const {
-    using namespace Galois::WorkList;
-    typedef dChunkedFIFO<64> dChunk;
-    typedef dVisChunkedFIFO<64> visChunk;
-    typedef dChunkedPTFIFO<1> noChunk;
-    typedef ChunkedFIFO<64> globChunk;
-    typedef ChunkedFIFO<1> globNoChunk;
-    typedef OrderedByIntegerMetric<Indexer,dChunk> OBIM;
-    typedef OrderedByIntegerMetric<Indexer,dChunkedLIFO<64>> OBIM_LIFO;
-    typedef OrderedByIntegerMetric<Indexer,dChunk, 4> OBIM_BLK4;
-    typedef OrderedByIntegerMetric<Indexer,dChunk, 0, false> OBIM_NOBSP;
-    typedef OrderedByIntegerMetric<Indexer,noChunk> OBIM_NOCHUNK;
-    typedef OrderedByIntegerMetric<Indexer,globChunk> OBIM_GLOB;
-    typedef OrderedByIntegerMetric<Indexer,globNoChunk> OBIM_GLOB_NOCHUNK;
-    typedef OrderedByIntegerMetric<Indexer,noChunk, -1, false> OBIM_STRICT;
-    typedef OrderedByIntegerMetric<Indexer,dChunk, 0,true, true> OBIM_UBSP;
-    typedef OrderedByIntegerMetric<Indexer,visChunk, 0,true, true> OBIM_VISCHUNK;
-    typedef dOrderedByIntegerMetric<Indexer,globChunk> DOBIM;
-    typedef dSkipListOrderedByIntegerMetric<Indexer, globChunk> SLDOBIM;
-    typedef mqSkipListOrderedByIntegerMetric<Indexer, globChunk> MQ4_SLDOBIM;
-    typedef swarmSkipListOrderedByIntegerMetric<Indexer, globChunk> SWARM_SLDOBIM;
-    typedef GlobPQ<WorkItem, LockFreeSkipList<Comparer, WorkItem>> GPQ;
-    typedef GlobPQ<WorkItem, LockFreeSkipList<NodeComparer, WorkItem>> GPQ_NC;
-    typedef GlobPQ<WorkItem, SprayList<NodeComparer, WorkItem>> SL;
-    typedef GlobPQ<WorkItem, MultiQueue<Comparer, WorkItem, 1>> MQ1;
-    typedef GlobPQ<WorkItem, MultiQueue<Comparer, WorkItem, 4>> MQ4;
-    typedef GlobPQ<WorkItem, MultiQueue<NodeComparer, WorkItem, 4>> MQ4_NC;
-    typedef GlobPQ<WorkItem, HeapMultiQueue<Comparer, WorkItem, 1>> HMQ1;
-    typedef GlobPQ<WorkItem, HeapMultiQueue<Comparer, WorkItem, 4>> HMQ4;
-    typedef GlobPQ<WorkItem, HeapMultiQueue<NodeComparer, WorkItem, 4>> HMQ4_NC;
-    typedef GlobPQ<WorkItem, DistQueue<Comparer, WorkItem, false>> PTSL;
-    typedef GlobPQ<WorkItem, DistQueue<Comparer, WorkItem, true>> PPSL;
-    typedef GlobPQ<WorkItem, LocalPQ<Comparer, WorkItem, false>> LPQ;
-    typedef GlobPQ<WorkItem, LocalPQ<Comparer, WorkItem, true>> LPQPS;
-    typedef GlobPQ<WorkItem, SwarmPQ<Comparer, WorkItem>> SWARMPQ;
-    typedef GlobPQ<WorkItem, SwarmPQ<NodeComparer, WorkItem>> SWARMPQ_NC;
-    typedef GlobPQ<WorkItem, HeapSwarmPQ<Comparer, WorkItem>> HSWARMPQ;
-    typedef GlobPQ<WorkItem, HeapSwarmPQ<NodeComparer, WorkItem>> HSWARMPQ_NC;
-    typedef GlobPQ<WorkItem, PartitionPQ<Comparer, Hasher, WorkItem>> PPQ;
-    typedef SkipListOrderedByIntegerMetric<Indexer, dChunk> SLOBIM;
-    typedef SkipListOrderedByIntegerMetric<Indexer, noChunk> SLOBIM_NOCHUNK;
-    typedef SkipListOrderedByIntegerMetric<Indexer, visChunk> SLOBIM_VISCHUNK;
-    typedef VectorOrderedByIntegerMetric<Indexer,dChunk> VECOBIM;
-    typedef VectorOrderedByIntegerMetric<Indexer,noChunk> VECOBIM_NOCHUNK;
-    typedef VectorOrderedByIntegerMetric<Indexer,globNoChunk> VECOBIM_GLOB_NOCHUNK;
-    typedef OrderedByIntegerMetric<Indexer,GPQ> OBIM_BAG_SL;
-    typedef OrderedByIntegerMetric<Indexer,GPQ_NC> OBIM_BAG_SL_NODECMP;
-    typedef OrderedByIntegerMetric<Indexer,HMQ4> OBIM_BAG_HMQ4;
-    typedef GlobPQ<WorkItem, kLSMQ<WorkItem, Indexer, 256>> kLSM256;
-    typedef GlobPQ<WorkItem, kLSMQ<WorkItem, Indexer, 4096>> kLSM4096;
+  typedef Galois::WorkList::SchedulerTraits<WorkItem, Indexer, Comparer, NodeComparer, Hasher> Traits;
+  typedef Galois::WorkList::SchedulerRegistry<Traits> Schedulers;
 
+  struct RunLoop {
+    Graph& graph;
+    const GNode& source;
+    RunLoop(Graph& g, const GNode& s): graph(g), source(s) { }
+    template<typename S>
+    void operator()(S) {
+      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<typename S::type>());
+    }
+  };
+
+  void operator()(Graph& graph, const GNode& source) const {
     graph.getData(source).dist = 0;
 
     std::string wl = worklistname;
     if (wl.find("obim") == std::string::npos)
       stepShift = 0;
     std::cout << "INFO: Using delta-step of " << (1 << stepShift) << "\n";
-    if (wl == "obim")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<OBIM>());
-    else if (wl == "slobim")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<SLOBIM>());
-    else if (wl == "slobim-nochunk")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<SLOBIM_NOCHUNK>());
-    else if (wl == "slobim-vischunk")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<SLOBIM_VISCHUNK>());
-    else if (wl == "vecobim")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<VECOBIM>());
-    else if (wl == "vecobim-nochunk")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<VECOBIM_NOCHUNK>());
-    else if (wl == "vecobim-glob-nochunk")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<VECOBIM_GLOB_NOCHUNK>());
-    else if (wl == "obim-strict")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<OBIM_STRICT>());
-    else if (wl == "obim-ubsp")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<OBIM_UBSP>());
-    else if (wl == "obim-lifo")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<OBIM_LIFO>());
-    else if (wl == "obim-blk4")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<OBIM_BLK4>());
-    else if (wl == "obim-nobsp")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<OBIM_NOBSP>());
-    else if (wl == "obim-nochunk")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<OBIM_NOCHUNK>());
-    else if (wl == "obim-vischunk")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<OBIM_VISCHUNK>());
-    else if (wl == "obim-glob")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<OBIM_GLOB>());
-    else if (wl == "obim-glob-nochunk")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<OBIM_GLOB_NOCHUNK>());
-    else if (wl == "obim-bag-sl")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<OBIM_BAG_SL>());
-    else if (wl == "obim-bag-sl-nodecmp")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<OBIM_BAG_SL_NODECMP>());
-    else if (wl == "obim-bag-multiqueue4")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<OBIM_BAG_HMQ4>());
-    else if (wl == "dobim")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<DOBIM>());
-    else if (wl == "sldobim")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<SLDOBIM>());
-    else if (wl == "mq4-sldobim")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<MQ4_SLDOBIM>());
-    else if (wl == "swarm-sldobim")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<SWARM_SLDOBIM>());
-    else if (wl == "skiplist")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<GPQ>());
-    else if (wl == "skiplist-nc")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<GPQ_NC>());
-    else if (wl == "spraylist")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<SL>());
-    else if (wl == "multiqueue1")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<MQ1>());
-    else if (wl == "multiqueue4")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<MQ4>());
-    else if (wl == "multiqueue4-nc")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<MQ4_NC>());
-    else if (wl == "heapmultiqueue1")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<HMQ1>());
-    else if (wl == "heapmultiqueue4")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<HMQ4>());
-    else if (wl == "heapmultiqueue4-nc")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<HMQ4_NC>());
-    else if (wl == "thrskiplist")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<PTSL>());
-    else if (wl == "pkgskiplist")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<PPSL>());
-    else if (wl == "lpq")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<LPQ>());
-    else if (wl == "lpqps")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<LPQPS>());
-    else if (wl == "swarm")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<SWARMPQ>());
-    else if (wl == "swarm-nc")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<SWARMPQ_NC>());
-    else if (wl == "heapswarm")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<HSWARMPQ>());
-    else if (wl == "heapswarm-nc")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<HSWARMPQ_NC>());
-    else if (wl == "ppq")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<PPQ>());
-    else if (wl == "klsm256")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<kLSM256>());
-    else if (wl == "klsm4096")
-      Galois::for_each(WorkItem(source, 1), Process(graph), Galois::wl<kLSM4096>());
-    else
-      std::cerr << "No work list!" << "\n";
+    RunLoop run(graph, source);
+    if (!Schedulers::run(wl, run))
+      Schedulers::printNames(std::cerr << "No work list! Choose one of:") << "\n";
   }
 };
 
@@ -27,6 +27,7 @@
 #include "Galois/Timer.h"
 #include "Galois/Galois.h"
 #include "Galois/Graph/LCGraph.h"
+#include "Galois/WorkList/SchedulerRegistry.h"
 
 #include "llvm/Support/CommandLine.h"
 #include "Lonestar/BoilerPlate.h"
@@ -303,41 +304,20 @@ struct seq_gt: public std::binary_function<const std::pair<GNode,unsigned>&, con
 //End body of for-each.
 ///////////////////////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////////////////////
+typedef std::pair<GNode,unsigned> WorkItem;
+typedef Galois::WorkList::SchedulerTraits<WorkItem, Indexer, seq_gt, seq_gt, void, 64, 10> SchedTraits;
+
+struct RunLoop {
+   Bag& initial;
+   RunLoop(Bag& i): initial(i) { }
+   template<typename S>
+   void operator()(S) {
+      Galois::for_each_local(initial, process(), Galois::wl<typename S::type>());
+   }
+};
+
 EdgeDataType runBodyParallel() {
-   using namespace Galois::WorkList;
-   typedef dChunkedFIFO<64> Chunk;
-   typedef dVisChunkedFIFO<64> visChunk;
-   typedef dChunkedPTFIFO<1> noChunk;
-   typedef ChunkedFIFO<64> globChunk;
-   typedef ChunkedFIFO<1> globNoChunk;
-   typedef OrderedByIntegerMetric<Indexer, Chunk, 10> OBIM;
-   typedef OrderedByIntegerMetric<Indexer, dChunkedLIFO<64>, 10> OBIM_LIFO;
-   typedef OrderedByIntegerMetric<Indexer, Chunk, 4> OBIM_BLK4;
-   typedef OrderedByIntegerMetric<Indexer, Chunk, 10, false> OBIM_NOBSP;
-   typedef OrderedByIntegerMetric<Indexer, noChunk, 10> OBIM_NOCHUNK;
-   typedef OrderedByIntegerMetric<Indexer, globChunk, 10> OBIM_GLOB;
-   typedef OrderedByIntegerMetric<Indexer, globNoChunk, 10> OBIM_GLOB_NOCHUNK;
-   typedef OrderedByIntegerMetric<Indexer, noChunk, -1, false> OBIM_STRICT;
-   typedef OrderedByIntegerMetric<Indexer, Chunk, 10, true, true> OBIM_UBSP;
-   typedef OrderedByIntegerMetric<Indexer, visChunk, 10, true, true> OBIM_VISCHUNK;
-   typedef std::pair<GNode,unsigned> WorkItem;
-   typedef GlobPQ<WorkItem, LockFreeSkipList<seq_gt, WorkItem>> GPQ;
-   typedef GlobPQ<WorkItem, SprayList<seq_gt, WorkItem>> SL;
-   typedef GlobPQ<WorkItem, MultiQueue<seq_gt, WorkItem, 1>> MQ1;
-   typedef GlobPQ<WorkItem, MultiQueue<seq_gt, WorkItem, 4>> MQ4;
-   typedef GlobPQ<WorkItem, HeapMultiQueue<seq_gt, WorkItem, 1>> HMQ1;
-   typedef GlobPQ<WorkItem, HeapMultiQueue<seq_gt, WorkItem, 4>> HMQ4;
-   typedef GlobPQ<WorkItem, DistQueue<seq_gt, WorkItem, false>> PTSL;
-   typedef GlobPQ<WorkItem, DistQueue<seq_gt, WorkItem, true>> PPSL;
-   typedef GlobPQ<WorkItem, LocalPQ<seq_gt, WorkItem, false>> LPQ;
-   typedef GlobPQ<WorkItem, SwarmPQ<seq_gt, WorkItem>> SWARMPQ;
-   typedef GlobPQ<WorkItem, HeapSwarmPQ<seq_gt, WorkItem>> HSWARMPQ;
-   typedef SkipListOrderedByIntegerMetric<Indexer, Chunk, 10> SLOBIM;
-   typedef SkipListOrderedByIntegerMetric<Indexer, noChunk, 10> SLOBIM_NOCHUNK;
-   typedef SkipListOrderedByIntegerMetric<Indexer, visChunk, 10> SLOBIM_VISCHUNK;
-   typedef VectorOrderedByIntegerMetric<Indexer, Chunk, 10> VECOBIM;
-   typedef VectorOrderedByIntegerMetric<Indexer, noChunk, 10> VECOBIM_NOCHUNK;
-   typedef VectorOrderedByIntegerMetric<Indexer, globNoChunk, 10> VECOBIM_GLOB_NOCHUNK;
+   typedef Galois::WorkList::SchedulerRegistry<SchedTraits> Schedulers;
 
    size_t approxNodeData = graph.size() * 128;
    Galois::preAlloc(numThreads + 3 * approxNodeData / Galois::Runtime::MM::pageSize);
@@ -361,65 +341,11 @@ EdgeDataType runBodyParallel() {
    Galois::StatTimer T;
    T.start();
 #ifdef GALOIS_USE_EXP
-   Exp::PriAuto<64, Indexer, OBIM, seq_less, seq_gt>::for_each(graph.begin(), graph.end(), process());
+   Exp::PriAuto<64, Indexer, Schedulers::OBIM, seq_less, seq_gt>::for_each(graph.begin(), graph.end(), process());
 #else
-   std::string wl = worklistname;
-   if (wl == "obim")
-   Galois::for_each_local(initial, process(), Galois::wl<OBIM>());
-   else if (wl == "slobim")
-     Galois::for_each_local(initial, process(), Galois::wl<SLOBIM>());
-   else if (wl == "slobim-nochunk")
-     Galois::for_each_local(initial, process(), Galois::wl<SLOBIM_NOCHUNK>());
-   else if (wl == "slobim-vischunk")
-     Galois::for_each_local(initial, process(), Galois::wl<SLOBIM_VISCHUNK>());
-   else if (wl == "vecobim")
-     Galois::for_each_local(initial, process(), Galois::wl<VECOBIM>());
-   else if (wl == "vecobim-nochunk")
-     Galois::for_each_local(initial, process(), Galois::wl<VECOBIM_NOCHUNK>());
-   else if (wl == "vecobim-glob-nochunk")
-     Galois::for_each_local(initial, process(), Galois::wl<VECOBIM_GLOB_NOCHUNK>());
-   else if (wl == "obim-strict")
-     Galois::for_each_local(initial, process(), Galois::wl<OBIM_STRICT>());
-   else if (wl == "obim-ubsp")
-     Galois::for_each_local(initial, process(), Galois::wl<OBIM_UBSP>());
-   else if (wl == "obim-lifo")
-     Galois::for_each_local(initial, process(), Galois::wl<OBIM_LIFO>());
-   else if (wl == "obim-blk4")
-     Galois::for_each_local(initial, process(), Galois::wl<OBIM_BLK4>());
-   else if (wl == "obim-nobsp")
-     Galois::for_each_local(initial, process(), Galois::wl<OBIM_NOBSP>());
-   else if (wl == "obim-nochunk")
-     Galois::for_each_local(initial, process(), Galois::wl<OBIM_NOCHUNK>());
-   else if (wl == "obim-vischunk")
-     Galois::for_each_local(initial, process(), Galois::wl<OBIM_VISCHUNK>());
-   else if (wl == "obim-glob")
-     Galois::for_each_local(initial, process(), Galois::wl<OBIM_GLOB>());
-   else if (wl == "obim-glob-nochunk")
-     Galois::for_each_local(initial, process(), Galois::wl<OBIM_GLOB_NOCHUNK>());
-   else if (wl == "skiplist")
-     Galois::for_each_local(initial, process(), Galois::wl<GPQ>());
-   else if (wl == "spraylist")
-     Galois::for_each_local(initial, process(), Galois::wl<SL>());
-   else if (wl == "multiqueue1")
-     Galois::for_each_local(initial, process(), Galois::wl<MQ1>());
-   else if (wl == "multiqueue4")
-     Galois::for_each_local(initial, process(), Galois::wl<MQ4>());
-   else if (wl == "heapmultiqueue1")
-     Galois::for_each_local(initial, process(), Galois::wl<HMQ1>());
-   else if (wl == "heapmultiqueue4")
-     Galois::for_each_local(initial, process(), Galois::wl<HMQ4>());
-   else if (wl == "thrskiplist")
-     Galois::for_each_local(initial, process(), Galois::wl<PTSL>());
-   else if (wl == "pkgskiplist")
-     Galois::for_each_local(initial, process(), Galois::wl<PPSL>());
-   else if (wl == "lpq")
-     Galois::for_each_local(initial, process(), Galois::wl<LPQ>());
-   else if (wl == "swarm")
-     Galois::for_each_local(initial, process(), Galois::wl<SWARMPQ>());
-   else if (wl == "heapswarm")
-     Galois::for_each_local(initial, process(), Galois::wl<HSWARMPQ>());
-   else
-     std::cerr << "No work list!" << "\n";
+   RunLoop run(initial);
+   if (!Schedulers::run(worklistname, run))
+     Schedulers::printNames(std::cerr << "No work list! Choose one of:") << "\n";
 #endif
    T.stop();
 
@@ -29,6 +29,7 @@
 #include "Galois/Statistic.h"
 #include "Galois/Graph/LCGraph.h"
 #include "Galois/Graph/TypeTraits.h"
+#include "Galois/WorkList/SchedulerRegistry.h"
 #include "Lonestar/BoilerPlate.h"
 
 #include GALOIS_CXX11_STD_HEADER(atomic)
@@ -502,6 +503,26 @@ struct AsyncPri{
     }
   };
 
+  typedef std::pair<GNode, int> WorkItem;
+  typedef Galois::WorkList::SchedulerTraits<WorkItem, sndPri, UpdateRequestComparer<WorkItem>,
+      UpdateRequestNodeComparer<WorkItem>, UpdateRequestHasher<WorkItem>, 32, 10> Traits;
+  typedef Galois::WorkList::SchedulerRegistry<Traits> Schedulers;
+
+  template<typename FnTy>
+  struct RunLoop {
+    Graph& graph;
+    PRTy tolerance;
+    PRTy amp;
+    FnTy& fn;
+    RunLoop(Graph& g, PRTy t, PRTy a, FnTy& f): graph(g), tolerance(t), amp(a), fn(f) { }
+    template<typename S>
+    void operator()(S) {
+      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
+                       boost::make_transform_iterator(graph.end(), std::ref(fn)),
+                       Process(graph, tolerance, amp), Galois::wl<typename S::type>());
+    }
+  };
+
   void cleanup(){
 
   }
@@ -511,53 +532,8 @@ struct AsyncPri{
 
 
     initResidual(graph);
-    typedef Galois::WorkList::dChunkedFIFO<32> WL;
-    typedef Galois::WorkList::OrderedByIntegerMetric<sndPri,WL>::with_block_period<8>::type OBIM;
     Galois::InsertBag<std::pair<GNode, int> > bag;
 
-    using namespace Galois::WorkList;
-    typedef dChunkedFIFO<32> Chunk;
-    typedef dVisChunkedFIFO<32> visChunk;
-    typedef dChunkedPTFIFO<1> noChunk;
-    typedef ChunkedFIFO<32> globChunk;
-    typedef ChunkedFIFO<1> globNoChunk;
-    //typedef OrderedByIntegerMetric<sndPri, Chunk, 10> OBIM;
-    typedef OrderedByIntegerMetric<sndPri, dChunkedLIFO<32>, 10> OBIM_LIFO;
-    typedef OrderedByIntegerMetric<sndPri, Chunk, 4> OBIM_BLK4;
-    typedef OrderedByIntegerMetric<sndPri, Chunk, 10, false> OBIM_NOBSP;
-    typedef OrderedByIntegerMetric<sndPri, noChunk, 10> OBIM_NOCHUNK;
-    typedef OrderedByIntegerMetric<sndPri, globChunk, 10> OBIM_GLOB;
-    typedef OrderedByIntegerMetric<sndPri, globNoChunk, 10> OBIM_GLOB_NOCHUNK;
-    typedef OrderedByIntegerMetric<sndPri, noChunk, -1, false> OBIM_STRICT;
-    typedef OrderedByIntegerMetric<sndPri, Chunk, 10, true, true> OBIM_UBSP;
-    typedef OrderedByIntegerMetric<sndPri, visChunk, 10, true, true> OBIM_VISCHUNK;
-    typedef UpdateRequestComparer<std::pair<GNode, int>> Comparer;
-    typedef UpdateRequestNodeComparer<std::pair<GNode, int>> NodeComparer;
-    typedef UpdateRequestHasher<std::pair<GNode, int>> Hasher;
-    typedef GlobPQ<std::pair<GNode, int>, LockFreeSkipList<Comparer, std::pair<GNode, int>>> GPQ;
-    typedef GlobPQ<std::pair<GNode, int>, LockFreeSkipList<NodeComparer, std::pair<GNode, int>>> GPQ_NC;
-    typedef GlobPQ<std::pair<GNode, int>, SprayList<NodeComparer, std::pair<GNode, int>>> SL;
-    typedef GlobPQ<std::pair<GNode, int>, MultiQueue<Comparer, std::pair<GNode, int>, 1>> MQ1;
-    typedef GlobPQ<std::pair<GNode, int>, MultiQueue<Comparer, std::pair<GNode, int>, 4>> MQ4;
-    typedef GlobPQ<std::pair<GNode, int>, MultiQueue<NodeComparer, std::pair<GNode, int>, 4>> MQ4_NC;
-    typedef GlobPQ<std::pair<GNode, int>, HeapMultiQueue<Comparer, std::pair<GNode, int>, 1>> HMQ1;
-    typedef GlobPQ<std::pair<GNode, int>, HeapMultiQueue<Comparer, std::pair<GNode, int>, 4>> HMQ4;
-    typedef GlobPQ<std::pair<GNode, int>, DistQueue<Comparer, std::pair<GNode, int>, false>> PTSL;
-    typedef GlobPQ<std::pair<GNode, int>, DistQueue<Comparer, std::pair<GNode, int>, true>> PPSL;
-    typedef GlobPQ<std::pair<GNode, int>, LocalPQ<Comparer, std::pair<GNode, int>, false>> LPQ;
-    typedef GlobPQ<std::pair<GNode, int>, SwarmPQ<Comparer, std::pair<GNode, int>>> SWARMPQ;
-    typedef GlobPQ<std::pair<GNode, int>, SwarmPQ<NodeComparer, std::pair<GNode, int>>> SWARMPQ_NC;
-    typedef GlobPQ<std::pair<GNode, int>, HeapSwarmPQ<Comparer, std::pair<GNode, int>>> HSWARMPQ;
-    typedef GlobPQ<std::pair<GNode, int>, PartitionPQ<Comparer, Hasher, std::pair<GNode, int>>> PPQ;
-    typedef SkipListOrderedByIntegerMetric<sndPri, Chunk, 10> SLOBIM;
-    typedef SkipListOrderedByIntegerMetric<sndPri, noChunk, 10> SLOBIM_NOCHUNK;
-    typedef SkipListOrderedByIntegerMetric<sndPri, visChunk, 10> SLOBIM_VISCHUNK;
-    typedef VectorOrderedByIntegerMetric<sndPri, Chunk, 10> VECOBIM;
-    typedef VectorOrderedByIntegerMetric<sndPri, noChunk, 10> VECOBIM_NOCHUNK;
-    typedef VectorOrderedByIntegerMetric<sndPri, globNoChunk, 10> VECOBIM_GLOB_NOCHUNK;
-    typedef GlobPQ<std::pair<GNode, int>, kLSMQ<std::pair<GNode, int>, sndPri, 256>> kLSM256;
-    typedef GlobPQ<std::pair<GNode, int>, kLSMQ<std::pair<GNode, int>, sndPri, 4096>> kLSM4096;
-
     PRPri pri(graph, tolerance);
     // Galois::do_all_local(graph, [&graph, &bag, &pri] (const GNode& node) {
     //     bag.push(std::make_pair(node, pri(node)));
@@ -566,143 +542,9 @@ struct AsyncPri{
 
     auto fn = [&pri] (const GNode& node) { return std::make_pair(node, pri(node)); };
     std::string wl = worklistname_;
-    if (wl == "obim")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<OBIM>());
-    else if (wl == "slobim")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<SLOBIM>());
-    else if (wl == "slobim-nochunk")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<SLOBIM_NOCHUNK>());
-    else if (wl == "slobim-vischunk")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<SLOBIM_VISCHUNK>());
-    else if (wl == "vecobim")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<VECOBIM>());
-    else if (wl == "vecobim-nochunk")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<VECOBIM_NOCHUNK>());
-    else if (wl == "vecobim-glob-nochunk")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<VECOBIM_GLOB_NOCHUNK>());
-    else if (wl == "obim-strict")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<OBIM_STRICT>());
-    else if (wl == "obim-ubsp")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<OBIM_UBSP>());
-    else if (wl == "obim-lifo")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<OBIM_LIFO>());
-    else if (wl == "obim-blk4")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<OBIM_BLK4>());
-    else if (wl == "obim-nobsp")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<OBIM_NOBSP>());
-    else if (wl == "obim-nochunk")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<OBIM_NOCHUNK>());
-    else if (wl == "obim-vischunk")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<OBIM_VISCHUNK>());
-    else if (wl == "obim-glob")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<OBIM_GLOB>());
-    else if (wl == "obim-glob-nochunk")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<OBIM_GLOB_NOCHUNK>());
-    else if (wl == "skiplist")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<GPQ>());
-    else if (wl == "skiplist-nc")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<GPQ_NC>());
-    else if (wl == "spraylist")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<SL>());
-    else if (wl == "multiqueue1")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<MQ1>());
-    else if (wl == "multiqueue4")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<MQ4>());
-    else if (wl == "multiqueue4-nc")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<MQ4_NC>());
-    else if (wl == "heapmultiqueue1")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<HMQ1>());
-    else if (wl == "heapmultiqueue4")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<HMQ4>());
-    else if (wl == "thrskiplist")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<PTSL>());
-    else if (wl == "pkgskiplist")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<PPSL>());
-    else if (wl == "lpq")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<LPQ>());
-    else if (wl == "swarm")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<SWARMPQ>());
-    else if (wl == "swarm-nc")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<SWARMPQ_NC>());
-    else if (wl == "heapswarm")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<HSWARMPQ>());
-    else if (wl == "ppq")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<PPQ>());
-    else if (wl == "klsm256")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<kLSM256>());
-    else if (wl == "klsm4096")
-      Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<kLSM4096>());
-    else
-      std::cerr << "No work list!" << "\n";
-    /*Galois::for_each(boost::make_transform_iterator(graph.begin(), std::ref(fn)),
-                     boost::make_transform_iterator(graph.end(), std::ref(fn)),
-                     Process(graph, tolerance, amp), Galois::wl<SL>());*/
+    RunLoop<decltype(fn)> run(graph, tolerance, amp, fn);
+    if (!Schedulers::run(wl, run))
+      Schedulers::printNames(std::cerr << "No work list! Choose one of:") << "\n";
     std::cout<< "here2\n";
 
   }
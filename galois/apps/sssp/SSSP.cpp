@@ -42,6 +42,7 @@
 #include "GraphLabAlgo.h"
 #include "LigraAlgo.h"
 #include "../../include/Galois/WorkList/WorkListHelpers.h"
+#include "Galois/WorkList/SchedulerRegistry.h"
 
 namespace cll = llvm::cl;
 
@@ -67,6 +68,12 @@ static cll::opt<bool> symmetricGraph("symmetricGraph", cll::desc("Input graph is
 static cll::opt<unsigned int> startNode("startNode", cll::desc("Node to start search from"), cll::init(0));
 static cll::opt<unsigned int> reportNode("reportNode", cll::desc("Node to report distance to"), cll::init(1));
 static cll::opt<int> stepShift("delta", cll::desc("Shift value for the deltastep"), cll::init(10));
+static cll::opt<int> prioShift("prioShift", cll::desc("Shift value applied to distances used as k-LSM priorities"), cll::init(0));
+static cll::opt<int> klsmRlx("klsmRlx", cll::desc("Relaxation of the klsm worklists (at most 65536)"), cll::init(256));
+static cll::opt<bool> klsmTune("klsmTune", cll::desc("Tune the k-LSM relaxation to contention and rank error at runtime"), cll::init(false));
+static cll::opt<bool> prefetch("prefetch", cll::desc("Prefetch the nodes of upcoming work items (worklists without breaks)"), cll::init(false));
+static cll::opt<bool> batch("batch", cll::desc("Process popped items in batches (asyncWithCas on worklists without breaks)"), cll::init(false));
+static cll::opt<unsigned> klsmBudget("klsmBudget", cll::desc("Soft limit on memory retained by the k-LSM in MB (0 for none)"), cll::init(0));
 cll::opt<unsigned int> memoryLimit("memoryLimit",
     cll::desc("Memory limit for out-of-core algorithms (in MB)"), cll::init(~0U));
 static cll::opt<Algo> algo("algo", cll::desc("Choose an algorithm:"),
@@ -151,6 +158,22 @@ struct UpdateRequestIndexer: public std::unary_function<UpdateRequest, unsigned
   }
 };
 
+//! Full precision priorities for the k-LSM, independent of the delta parameter
+template<typename UpdateRequest>
+struct UpdateRequestPrioIndexer: public std::unary_function<UpdateRequest, Dist> {
+  Dist operator() (const UpdateRequest& val) const {
+    return val.w >> prioShift;
+  }
+};
+
+//! Like UpdateRequestPrioIndexer but breaks ties by node
+template<typename UpdateRequest>
+struct UpdateRequestNodePrioIndexer: public std::unary_function<UpdateRequest, std::pair<Dist, uintptr_t> > {
+  std::pair<Dist, uintptr_t> operator() (const UpdateRequest& val) const {
+    return std::make_pair(val.w >> prioShift, val.getID());
+  }
+};
+
 template<typename UpdateRequest>
 struct UpdateRequestHasher: public std::unary_function<UpdateRequest, unsigned long> {
   unsigned long operator() (const UpdateRequest& val) const {
@@ -336,6 +359,7 @@ struct AsyncAlgo {
 
 
     if (req.w != (unsigned int)*sdist) {
+      Galois::WorkList::OBIMDeltaFeedback::wastedWork();
       if (trackWork) {
         *nEmpty += 1;
         *WLEmptyWork += pusher.t.stopwatch();
@@ -345,6 +369,7 @@ struct AsyncAlgo {
 
     for (typename Graph::edge_iterator ii = graph.edge_begin(req.n, flag), ei = graph.edge_end(req.n, flag); ii != ei; ++ii) {
       if (req.w != (unsigned int)*sdist) {
+        Galois::WorkList::OBIMDeltaFeedback::wastedWork();
         *nBad += nEdge;
         *nOverall += nEdge;
         *BadWork += pusher.u + pusher.t.sample();
@@ -389,6 +414,13 @@ struct AsyncAlgo {
     }
   };
 
+  struct ProcessPrefetch: public Process {
+    ProcessPrefetch(AsyncAlgo* s, Graph& g): Process(s, g) { }
+    void prefetch(const UpdateRequest& req) {
+      __builtin_prefetch(&this->graph.getData(req.n, Galois::MethodFlag::NONE));
+    }
+  };
+
   struct ProcessWithBreaks {
     typedef int tt_needs_parallel_break;
 
@@ -400,6 +432,22 @@ struct AsyncAlgo {
     }
   };
 
+  struct ProcessBatch {
+    typedef int tt_needs_batch;
+    typedef int tt_does_not_need_aborts;
+
+    AsyncAlgo* self;
+    Graph& graph;
+    ProcessBatch(AsyncAlgo* s, Graph& g): self(s), graph(g) { }
+    void prefetch(const UpdateRequest& req) {
+      __builtin_prefetch(&graph.getData(req.n, Galois::MethodFlag::NONE));
+    }
+    void operator()(UpdateRequest* b, UpdateRequest* e, Galois::UserContext<UpdateRequest>& ctx) {
+      for (UpdateRequest* ii = b; ii != e; ++ii)
+        self->relaxNode(graph, *ii, ctx);
+    }
+  };
+
   typedef Galois::InsertBag<UpdateRequest> Bag;
 
   struct InitialProcess {
@@ -413,69 +461,58 @@ struct AsyncAlgo {
     }
   };
 
+  struct Traits: public Galois::WorkList::SchedulerTraits<UpdateRequest,
+      UpdateRequestIndexer<UpdateRequest>, UpdateRequestComparer<UpdateRequest>,
+      UpdateRequestNodeComparer<UpdateRequest>, UpdateRequestHasher<UpdateRequest>, 64, 10> {
+    typedef UpdateRequestPrioIndexer<UpdateRequest> lsm_indexer;
+    typedef UpdateRequestNodePrioIndexer<UpdateRequest> lsm_node_indexer;
+  };
+  typedef Galois::WorkList::SchedulerRegistry<Traits> Schedulers;
+
+  struct RunLoop {
+    AsyncAlgo* self;
+    Graph& graph;
+    Bag& initial;
+    RunLoop(AsyncAlgo* s, Graph& g, Bag& i): self(s), graph(g), initial(i) { }
+    template<typename S>
+    void operator()(S) {
+      typedef typename std::conditional<S::breaks, ProcessWithBreaks, Process>::type Fn;
+      // Batches need an operator without aborts, i.e., updates by CAS
+      typedef typename std::conditional<UseCas && !S::breaks, ProcessBatch, Fn>::type BatchFn;
+      typedef typename std::conditional<S::breaks, ProcessWithBreaks, ProcessPrefetch>::type PrefetchFn;
+      if (batch)
+        Galois::for_each_local(initial, BatchFn(self, graph), Galois::wl<typename S::type>());
+      else if (prefetch)
+        Galois::for_each_local(initial, PrefetchFn(self, graph), Galois::wl<typename S::type>());
+      else
+        Galois::for_each_local(initial, Fn(self, graph), Galois::wl<typename S::type>());
+    }
+  };
+
   void operator()(Graph& graph, GNode source) {
     using namespace Galois::WorkList;
-    typedef dChunkedFIFO<64> Chunk;
-    typedef dVisChunkedFIFO<64> visChunk;
-    typedef dChunkedPTFIFO<1> noChunk;
-    typedef ChunkedFIFO<64> globChunk;
-    typedef ChunkedFIFO<1> globNoChunk;
-    typedef OrderedByIntegerMetric<UpdateRequestIndexer<UpdateRequest>, Chunk, 10> OBIM;
-    typedef OrderedByIntegerMetric<UpdateRequestIndexer<UpdateRequest>, dChunkedLIFO<64>, 10> OBIM_LIFO;
-    typedef OrderedByIntegerMetric<UpdateRequestIndexer<UpdateRequest>, Chunk, 4> OBIM_BLK4;
-    typedef OrderedByIntegerMetric<UpdateRequestIndexer<UpdateRequest>, Chunk, 10, false> OBIM_NOBSP;
-    typedef OrderedByIntegerMetric<UpdateRequestIndexer<UpdateRequest>, noChunk, 10> OBIM_NOCHUNK;
-    typedef OrderedByIntegerMetric<UpdateRequestIndexer<UpdateRequest>, globChunk, 10> OBIM_GLOB;
-    typedef OrderedByIntegerMetric<UpdateRequestIndexer<UpdateRequest>, globNoChunk, 10> OBIM_GLOB_NOCHUNK;
-    typedef OrderedByIntegerMetric<UpdateRequestIndexer<UpdateRequest>, noChunk, -1, false> OBIM_STRICT;
-    typedef OrderedByIntegerMetric<UpdateRequestIndexer<UpdateRequest>, Chunk, 10, true, true> OBIM_UBSP;
-    typedef OrderedByIntegerMetric<UpdateRequestIndexer<UpdateRequest>, visChunk, 10, true, true> OBIM_VISCHUNK;
-    typedef dOrderedByIntegerMetric<UpdateRequestIndexer<UpdateRequest>, globChunk, 10> DOBIM;
-    typedef dSkipListOrderedByIntegerMetric<UpdateRequestIndexer<UpdateRequest>, globChunk, 10> SLDOBIM;
-    typedef mqSkipListOrderedByIntegerMetric<UpdateRequestIndexer<UpdateRequest>, globChunk, 10> MQ4_SLDOBIM;
-    typedef swarmSkipListOrderedByIntegerMetric<UpdateRequestIndexer<UpdateRequest>, globChunk, 10> SWARM_SLDOBIM;
-    typedef UpdateRequestComparer<UpdateRequest> Comparer;
-    typedef UpdateRequestNodeComparer<UpdateRequest> NodeComparer;
-    typedef UpdateRequestHasher<UpdateRequest> Hasher;
-    typedef GlobPQ<UpdateRequest, kLSMQ<UpdateRequest, UpdateRequestIndexer<UpdateRequest>, 256>> kLSM256;
-    typedef GlobPQ<UpdateRequest, kLSMQ<UpdateRequest, UpdateRequestIndexer<UpdateRequest>, 4096>> kLSM4096;
-    typedef GlobPQ<UpdateRequest, LockFreeSkipList<Comparer, UpdateRequest>> GPQ;
-    typedef GlobPQ<UpdateRequest, KiWiPQ<Comparer, GaloisAllocator, UpdateRequest>> KIWIPQ;
-    typedef GlobPQ<UpdateRequest, LockFreeSkipList<NodeComparer, UpdateRequest>> GPQ_NC;
-    typedef GlobPQ<UpdateRequest, SprayList<NodeComparer, UpdateRequest>> SL;
-    typedef GlobPQ<UpdateRequest, MultiQueue<Comparer, UpdateRequest, 1>> MQ1;
-    typedef GlobPQ<UpdateRequest, MultiQueue<Comparer, UpdateRequest, 4>> MQ4;
-    typedef GlobPQ<UpdateRequest, MultiQueue<NodeComparer, UpdateRequest, 4>> MQ4_NC;
-    typedef GlobPQ<UpdateRequest, HeapMultiQueue<Comparer, UpdateRequest, 1>> HMQ1;
-    typedef GlobPQ<UpdateRequest, HeapMultiQueue<Comparer, UpdateRequest, 4>> HMQ4;
-    typedef GlobPQ<UpdateRequest, HeapMultiQueue<NodeComparer, UpdateRequest, 4>> HMQ4_NC;
-    typedef GlobPQ<UpdateRequest, DistQueue<Comparer, UpdateRequest, false>> PTSL;
-    typedef GlobPQ<UpdateRequest, DistQueue<Comparer, UpdateRequest, true>> PPSL;
-    typedef GlobPQ<UpdateRequest, LocalPQ<Comparer, UpdateRequest, false>> LPQ;
-    typedef GlobPQ<UpdateRequest, LocalPQ<Comparer, UpdateRequest, true>> LPQPS;
-    typedef GlobPQ<UpdateRequest, SwarmPQ<Comparer, UpdateRequest>> SWARMPQ;
-    typedef GlobPQ<UpdateRequest, SwarmPQ<NodeComparer, UpdateRequest>> SWARMPQ_NC;
-    typedef GlobPQ<UpdateRequest, HeapSwarmPQ<Comparer, UpdateRequest>> HSWARMPQ;
-    typedef GlobPQ<UpdateRequest, HeapSwarmPQ<NodeComparer, UpdateRequest>> HSWARMPQ_NC;
-    typedef GlobPQ<UpdateRequest, PartitionPQ<Comparer, Hasher, UpdateRequest>> PPQ;
-    typedef SkipListOrderedByIntegerMetric<UpdateRequestIndexer<UpdateRequest>, Chunk, 10> SLOBIM;
-    typedef SkipListOrderedByIntegerMetric<UpdateRequestIndexer<UpdateRequest>, noChunk, 10> SLOBIM_NOCHUNK;
-    typedef SkipListOrderedByIntegerMetric<UpdateRequestIndexer<UpdateRequest>, globNoChunk, 10> SLOBIM_GLOB_NOCHUNK;
-    typedef SkipListOrderedByIntegerMetric<UpdateRequestIndexer<UpdateRequest>, visChunk, 10> SLOBIM_VISCHUNK;
-    typedef VectorOrderedByIntegerMetric<UpdateRequestIndexer<UpdateRequest>, Chunk, 10> VECOBIM;
-    typedef VectorOrderedByIntegerMetric<UpdateRequestIndexer<UpdateRequest>, noChunk, 10> VECOBIM_NOCHUNK;
-    typedef VectorOrderedByIntegerMetric<UpdateRequestIndexer<UpdateRequest>, globNoChunk, 10> VECOBIM_GLOB_NOCHUNK;
-    typedef OrderedByIntegerMetric<UpdateRequestIndexer<UpdateRequest>, GPQ, 10> OBIM_BAG_SL;
-    typedef OrderedByIntegerMetric<UpdateRequestIndexer<UpdateRequest>, GPQ_NC, 10> OBIM_BAG_SL_NODECMP;
-    typedef OrderedByIntegerMetric<UpdateRequestIndexer<UpdateRequest>, HMQ4, 10> OBIM_BAG_HMQ4;
 
     std::string wl = worklistname;
     if (wl.find("obim") == std::string::npos)
       stepShift = 0;
 
-    std::cout << "INFO: Using delta-step of " << (1 << stepShift) << "\n";
-    std::cout << "WARNING: Performance varies considerably due to delta parameter.\n";
-    std::cout << "WARNING: Do not expect the default to be good for your graph.\n";
+    if (wl.compare(0, 4, "klsm") == 0) {
+      kLSMConfig& config = kLSMConfig::get();
+      config.relaxation = klsmRlx;
+      config.tune = klsmTune;
+      config.memoryBudget = (size_t) klsmBudget << 20;
+    }
+
+    if (wl == "obim-adapt") {
+      // The worklist applies the delta itself
+      OBIMDeltaConfig::get().initialShift = stepShift;
+      std::cout << "INFO: Adapting delta-step at runtime, starting from " << (1 << stepShift) << "\n";
+      stepShift = 0;
+    } else {
+      std::cout << "INFO: Using delta-step of " << (1 << stepShift) << "\n";
+      std::cout << "WARNING: Performance varies considerably due to delta parameter.\n";
+      std::cout << "WARNING: Do not expect the default to be good for your graph.\n";
+    }
 
     Bag initial;
     graph.getData(source).dist = 0;
@@ -483,98 +520,9 @@ struct AsyncAlgo {
         graph.out_edges(source, Galois::MethodFlag::NONE).begin(),
         graph.out_edges(source, Galois::MethodFlag::NONE).end(),
         InitialProcess(this, graph, initial, graph.getData(source)));
-    if (wl == "obim")
-      Galois::for_each_local(initial, Process(this, graph), Galois::wl<OBIM>());
-    else if (wl == "slobim")
-      Galois::for_each_local(initial, Process(this, graph), Galois::wl<SLOBIM>());
-    else if (wl == "slobim-nochunk")
-      Galois::for_each_local(initial, Process(this, graph), Galois::wl<SLOBIM_NOCHUNK>());
-    else if (wl == "slobim-glob-nochunk")
-      Galois::for_each_local(initial, Process(this, graph), Galois::wl<SLOBIM_GLOB_NOCHUNK>());
-    else if (wl == "slobim-vischunk")
-      Galois::for_each_local(initial, Process(this, graph), Galois::wl<SLOBIM_VISCHUNK>());
-    else if (wl == "vecobim")
-      Galois::for_each_local(initial, Process(this, graph), Galois::wl<VECOBIM>());
-    else if (wl == "vecobim-nochunk")
-      Galois::for_each_local(initial, Process(this, graph), Galois::wl<VECOBIM_NOCHUNK>());
-    else if (wl == "vecobim-glob-nochunk")
-      Galois::for_each_local(initial, Process(this, graph), Galois::wl<VECOBIM_GLOB_NOCHUNK>());
-    else if (wl == "obim-strict")
-      Galois::for_each_local(initial, Process(this, graph), Galois::wl<OBIM_STRICT>());
-    else if (wl == "obim-ubsp")
-      Galois::for_each_local(initial, Process(this, graph), Galois::wl<OBIM_UBSP>());
-    else if (wl == "obim-lifo")
-      Galois::for_each_local(initial, Process(this, graph), Galois::wl<OBIM_LIFO>());
-    else if (wl == "obim-blk4")
-      Galois::for_each_local(initial, Process(this, graph), Galois::wl<OBIM_BLK4>());
-    else if (wl == "obim-nobsp")
-      Galois::for_each_local(initial, Process(this, graph), Galois::wl<OBIM_NOBSP>());
-    else if (wl == "obim-nochunk")
-      Galois::for_each_local(initial, Process(this, graph), Galois::wl<OBIM_NOCHUNK>());
-    else if (wl == "obim-vischunk")
-      Galois::for_each_local(initial, Process(this, graph), Galois::wl<OBIM_VISCHUNK>());
-    else if (wl == "obim-glob")
-      Galois::for_each_local(initial, Process(this, graph), Galois::wl<OBIM_GLOB>());
-    else if (wl == "obim-glob-nochunk")
-      Galois::for_each_local(initial, Process(this, graph), Galois::wl<OBIM_GLOB_NOCHUNK>());
-    else if (wl == "obim-bag-sl")
-      Galois::for_each_local(initial, Process(this, graph), Galois::wl<OBIM_BAG_SL>());
-    else if (wl == "obim-bag-sl-nodecmp")
-      Galois::for_each_local(initial, Process(this, graph), Galois::wl<OBIM_BAG_SL_NODECMP>());
-    else if (wl == "obim-bag-multiqueue4")
-      Galois::for_each_local(initial, Process(this, graph), Galois::wl<OBIM_BAG_HMQ4>());
-    else if (wl == "dobim")
-      Galois::for_each_local(initial, Process(this, graph), Galois::wl<DOBIM>());
-    else if (wl == "sldobim")
-      Galois::for_each_local(initial, Process(this, graph), Galois::wl<SLDOBIM>());
-    else if (wl == "mq4-sldobim")
-      Galois::for_each_local(initial, Process(this, graph), Galois::wl<MQ4_SLDOBIM>());
-    else if (wl == "swarm-sldobim")
-      Galois::for_each_local(initial, Process(this, graph), Galois::wl<SWARM_SLDOBIM>());
-    else if (wl == "skiplist")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<GPQ>());
-    else if (wl == "kiwi-pq")
-      Galois::for_each_local(initial, Process(this, graph), Galois::wl<KIWIPQ>());
-    else if (wl == "skiplist-nc")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<GPQ_NC>());
-    else if (wl == "spraylist")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<SL>());
-    else if (wl == "multiqueue1")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<MQ1>());
-    else if (wl == "multiqueue4")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<MQ4>());
-    else if (wl == "multiqueue4-nc")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<MQ4_NC>());
-    else if (wl == "heapmultiqueue1")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<HMQ1>());
-    else if (wl == "heapmultiqueue4")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<HMQ4>());
-    else if (wl == "heapmultiqueue4-nc")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<HMQ4_NC>());
-    else if (wl == "thrskiplist")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<PTSL>());
-    else if (wl == "pkgskiplist")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<PPSL>());
-    else if (wl == "lpq")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<LPQ>());
-    else if (wl == "lpqps")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<LPQPS>());
-    else if (wl == "swarm")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<SWARMPQ>());
-    else if (wl == "swarm-nc")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<SWARMPQ_NC>());
-    else if (wl == "heapswarm")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<HSWARMPQ>());
-    else if (wl == "heapswarm-nc")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<HSWARMPQ_NC>());
-    else if (wl == "ppq")
-      Galois::for_each_local(initial, ProcessWithBreaks(this, graph), Galois::wl<PPQ>());
-    else if (wl == "klsm256")
-      Galois::for_each_local(initial, Process(this, graph), Galois::wl<kLSM256>());
-    else if (wl == "klsm4096")
-      Galois::for_each_local(initial, Process(this, graph), Galois::wl<kLSM4096>());
-    else
-      std::cerr << "No work list!" << "\n";
+    RunLoop run(this, graph, initial);
+    if (!Schedulers::run(wl, run))
+      Schedulers::printNames(std::cerr << "No work list! Choose one of:") << "\n";
   }
 };
 
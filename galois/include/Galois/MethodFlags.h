@@ -31,13 +31,21 @@ namespace Galois {
  * Various methods take an optional parameter indicating what actions
  * the runtime should do on the user's behalf: (1) checking for conflicts,
  * and/or (2) saving undo information. By default, both are performed (ALL).
+ *
+ * READ checks for conflicts optimistically instead: the object is not
+ * acquired, only its version is remembered and validated when the
+ * iteration reaches its first write (a push or a method flagged WRITE).
+ * Operators must not modify shared data before that point nor depend on
+ * objects read optimistically after it, and objects they modify must
+ * still be acquired with CHECK_CONFLICT.
  */
 enum MethodFlag {
   NONE = 0,
   CHECK_CONFLICT = 1,
   SAVE_UNDO = 2,
   ALL = 3,
-  WRITE = 4
+  WRITE = 4,
+  READ = 8
 };
 
 //! Bitwise & for method flags
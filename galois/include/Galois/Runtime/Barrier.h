@@ -23,11 +23,15 @@
 #ifndef GALOIS_RUNTIME_BARRIER_H
 #define GALOIS_RUNTIME_BARRIER_H
 
+#include <stdint.h>
+
 namespace Galois {
 namespace Runtime {
 
 class Barrier {
 public:
+  enum ReduceOp { SUM, MIN, MAX };
+
   virtual ~Barrier();
 
   //not safe if any thread is in wait
@@ -39,6 +43,10 @@ public:
   //wait at this barrier
   void operator()(void) { wait(); }
 
+  //! Waits at this barrier and returns op applied to the values all
+  //! threads passed in. Barriers that cannot fuse reductions abort.
+  virtual uint64_t reduce(uint64_t val, ReduceOp op);
+
   virtual void before(void) {
   }
 
@@ -68,6 +76,19 @@ Barrier& getSystemBarrier();
  * returned barrier.
  */
 Barrier* createSimpleBarrier();
+
+/**
+ * Creates the spinning barriers getSystemBarrier() can choose from, e.g.,
+ * to compare them. MCS is a tree over threads, Topo a tree over packages
+ * whose leaders count down the threads of their package, and Hier, the
+ * system barrier, a dissemination barrier within each package plus a tree
+ * over package leaders that also fuses reductions. They are initialized to
+ * the current activeThreads. Client is responsible for deallocating the
+ * returned barrier.
+ */
+Barrier* createMCSBarrier();
+Barrier* createTopoBarrier();
+Barrier* createHierBarrier();
 }
 } // end namespace Galois
 
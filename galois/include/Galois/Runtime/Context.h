@@ -32,8 +32,11 @@
 
 #include <boost/utility.hpp>
 
+#include <atomic>
 #include <cassert>
 #include <cstdlib>
+#include <utility>
+#include <vector>
 
 #ifdef GALOIS_USE_LONGJMP
 #include <setjmp.h>
@@ -110,6 +113,7 @@ protected:
 class SimpleRuntimeContext: public LockManagerBase {
 protected:
   void acquire(Lockable* lockable) { }
+  void acquireRead(Lockable* lockable) { }
   void release (Lockable* lockable) {}
   virtual void subAcquire(Lockable* lockable);
   void addToNhood(Lockable* lockable) { }
@@ -133,10 +137,13 @@ class Lockable {
   //! Use an intrusive list to track neighborhood of a context without allocation overhead.
   //! Works for cases where a Lockable needs to be only in one context's neighborhood list
   Lockable* next;
+  //! Incremented whenever an owner releases the object, so optimistic
+  //! readers can tell whether it was acquired since they read it
+  std::atomic<unsigned> version;
   friend class LockManagerBase;
   friend class SimpleRuntimeContext;
 public:
-  Lockable() :next(0) {}
+  Lockable() :next(0), version(0) {}
 };
 
 class LockManagerBase: private boost::noncopyable {
@@ -161,6 +168,7 @@ protected:
   inline void release(Lockable* lockable) {
     assert(lockable != nullptr);
     assert(getOwner(lockable) == this);
+    lockable->version.fetch_add(1, std::memory_order_relaxed);
     lockable->owner.unlock_and_clear();
   }
 
@@ -178,10 +186,16 @@ protected:
 class SimpleRuntimeContext: public LockManagerBase {
   //! The locks we hold
   Lockable* locks;
+  //! Objects read optimistically and the versions seen
+  std::vector<std::pair<Lockable*, unsigned> > reads;
   bool customAcquire;
+  //! Reads have been validated; later reads acquire exclusively
+  bool failsafe;
 
 protected:
   friend void doAcquire(Lockable*);
+  friend void doAcquireRead(Lockable*);
+  friend void doCheckWrite();
 
   static SimpleRuntimeContext* getOwner(Lockable* lockable) {
     LockManagerBase* owner = LockManagerBase::getOwner (lockable);
@@ -197,14 +211,28 @@ protected:
   }
 
   void acquire(Lockable* lockable);
+  void acquireRead(Lockable* lockable);
   void release(Lockable* lockable);
 
+  //! Signals a conflict if any object read optimistically has been
+  //! acquired by another iteration since
+  void validateReads();
+
+  void reachFailsafe() {
+    if (!failsafe) {
+      failsafe = true;
+      validateReads();
+    }
+  }
+
 public:
-  SimpleRuntimeContext(bool child = false): locks(0), customAcquire(child) { }
+  SimpleRuntimeContext(bool child = false): locks(0), customAcquire(child), failsafe(false) { }
   virtual ~SimpleRuntimeContext() { }
 
   void startIteration() {
     assert(!locks);
+    assert(reads.empty());
+    failsafe = false;
   }
   
   unsigned cancelIteration();
@@ -241,6 +269,15 @@ inline bool shouldLock(const Galois::MethodFlag g) {
 #endif
 }
 
+//! Helper function to decide if the object should be read optimistically
+inline bool shouldRead(const Galois::MethodFlag g) {
+#ifdef GALOIS_USE_SEQ_ONLY
+  return false;
+#else
+  return (g & READ) != NONE;
+#endif
+}
+
 //! actual locking function.  Will always lock.
 inline void doAcquire(Lockable* lockable) {
   SimpleRuntimeContext* ctx = getThreadContext();
@@ -248,11 +285,20 @@ inline void doAcquire(Lockable* lockable) {
     ctx->acquire(lockable);
 }
 
+//! Remembers the version of an object read optimistically
+inline void doAcquireRead(Lockable* lockable) {
+  SimpleRuntimeContext* ctx = getThreadContext();
+  if (ctx)
+    ctx->acquireRead(lockable);
+}
+
 //! Master function which handles conflict detection
 //! used to acquire a lockable thing
 inline void acquire(Lockable* lockable, Galois::MethodFlag m) {
   if (shouldLock(m)) {
     doAcquire(lockable);
+  } else if (shouldRead(m)) {
+    doAcquireRead(lockable);
   }
 }
 
@@ -274,6 +320,17 @@ void signalConflict(Lockable*);
 
 void forceAbort();
 
+//! Object whose conflict last aborted an iteration of this thread; null if
+//! the abort was forced
+Lockable* getLastConflict();
+
+//! Counts a conflict on lockable and returns how many conflicts objects
+//! hashing to the same slot had recently, including this one
+unsigned recordConflictHotness(Lockable* lockable);
+
+//! Thread out of num that iterations conflicting on lockable are serialized on
+unsigned conflictOwner(Lockable* lockable, unsigned num);
+
 }
 } // end namespace Galois
 
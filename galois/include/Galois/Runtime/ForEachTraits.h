@@ -38,6 +38,8 @@ struct ForEachTraits {
   enum {
     NeedsStats = !Galois::does_not_need_stats<FunctionTy>::value,
     NeedsBreak = Galois::needs_parallel_break<FunctionTy>::value,
+    NeedsBatch = Galois::needs_batch<FunctionTy>::value,
+    NeedsPrefetch = Galois::has_prefetch<FunctionTy>::value,
     NeedsPush = !Galois::does_not_need_push<FunctionTy>::value,
     NeedsPIA = Galois::needs_per_iter_alloc<FunctionTy>::value,
     NeedsAborts = !Galois::does_not_need_aborts<FunctionTy>::value
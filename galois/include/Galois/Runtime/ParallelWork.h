@@ -38,10 +38,16 @@
 #include "Galois/Runtime/Termination.h"
 #include "Galois/Runtime/ThreadPool.h"
 #include "Galois/Runtime/UserContextAccess.h"
+#include "Galois/Runtime/ll/EnvCheck.h"
 #include "Galois/WorkList/GFifo.h"
 
 #include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <functional>
+#include <string>
+#include <type_traits>
 
 #ifdef GALOIS_USE_HTM
 #include <speculation.h>
@@ -54,6 +60,43 @@
 namespace Galois {
 //! Internal Galois functionality - Use at your own risk.
 namespace Runtime {
+
+/**
+ * How for_each loops time their iterations for the GaloisTime, UserTime,
+ * ConflictTime, PushTime, PopTime and EmptyPopTime statistics. Read when a
+ * loop starts; initialized from the GALOIS_LOOP_PROFILE environment
+ * variable: "full" (the default) times every iteration, "off" none, and a
+ * number N times one in N iterations and scales the totals by N.
+ *
+ * Counts (Iterations, nPush, nPop, ...) are always exact. Operators that
+ * read UserContext::t need full profiling, as the timer is only restarted
+ * for timed iterations.
+ */
+struct LoopProfileConfig {
+  //! Time one in period iterations; 0 disables timing
+  unsigned period;
+
+  static LoopProfileConfig& get() {
+    static LoopProfileConfig config = init();
+    return config;
+  }
+
+private:
+  static LoopProfileConfig init() {
+    LoopProfileConfig c = { 1 };
+    const char* s = getenv("GALOIS_LOOP_PROFILE");
+    if (!s || !strcmp(s, "full"))
+      return c;
+    if (!strcmp(s, "off"))
+      c.period = 0;
+    else if (atoi(s) > 0)
+      c.period = atoi(s);
+    else
+      LL::gWarn("ignoring unknown GALOIS_LOOP_PROFILE ", s);
+    return c;
+  }
+};
+
 namespace {
 
 template<bool Enabled> 
@@ -69,9 +112,16 @@ class LoopStatistics {
   unsigned long npop;
   unsigned long empty_pop_time;
   unsigned long nempty_pop;
+  //! Time per popped item of timed pops
+  Galois::Log2Histogram pop_latency;
+  Galois::SamplePacer pacer;
 
   const char* loopname;
 
+  unsigned period;
+  unsigned countdown;
+  bool timing;
+
 #ifdef GALOIS_USE_HTM
   TmReport_s start;
   void init() { 
@@ -114,23 +164,49 @@ public:
                                            push_time(0), npush(0),
                                            pop_time(0), npop(0),
                                            empty_pop_time(0), nempty_pop(0),
-                                           loopname(ln) { init(); }
+                                           loopname(ln),
+                                           period(LoopProfileConfig::get().period),
+                                           countdown(1), timing(period == 1) { init(); }
   ~LoopStatistics() {
     reportStat(loopname, "Conflicts", conflicts);
     reportStat(loopname, "Iterations", iterations);
-    reportStat(loopname, "GaloisTime", galois_time);
-    reportStat(loopname, "UserTime", user_time);
-    reportStat(loopname, "ConflictTime", conflict_time);
-    reportStat(loopname, "PushTime", push_time);
-    reportStat(loopname, "PopTime", pop_time);
-    reportStat(loopname, "EmptyPopTime", empty_pop_time);
+    reportStat(loopname, "GaloisTime", galois_time * period);
+    reportStat(loopname, "UserTime", user_time * period);
+    reportStat(loopname, "ConflictTime", conflict_time * period);
+    reportStat(loopname, "PushTime", push_time * period);
+    reportStat(loopname, "PopTime", pop_time * period);
+    reportStat(loopname, "EmptyPopTime", empty_pop_time * period);
     reportStat(loopname, "nPush", npush);
     reportStat(loopname, "nPop", npop);
     reportStat(loopname, "nEmptyPop", nempty_pop);
+    if (period)
+      reportHistogram(loopname, "PopTime", pop_latency);
     report();
   }
+  //! Time since the last lap if the current sample is timed, else 0
+  inline unsigned long lap(Timer& t) const {
+    return timing ? t.stopwatch() : 0;
+  }
+  //! Decides whether the next pop and iteration are timed
+  inline void begin_sample(Timer& t) {
+    if (period <= 1)
+      return;
+    bool wasTiming = timing;
+    timing = --countdown == 0;
+    if (timing) {
+      countdown = period;
+      if (!wasTiming)
+        t.start();
+    }
+  }
   inline void inc_iterations(int amount = 1) {
     iterations += amount;
+    if (pacer.due()) {
+      reportSample(loopname, "Iterations", iterations);
+      reportSample(loopname, "Conflicts", conflicts);
+      reportSample(loopname, "nPop", npop);
+      reportSample(loopname, "nEmptyPop", nempty_pop);
+    }
   }
   inline void inc_conflicts() {
     ++conflicts;
@@ -148,9 +224,11 @@ public:
     push_time += t;
     npush += n;
   }
-  inline void add_pop_time(unsigned long t) {
+  inline void add_pop_time(unsigned long t, unsigned int n = 1) {
     pop_time += t;
-    npop++;
+    npop += n;
+    if (timing && n)
+      pop_latency.add(t / n);
   }
   inline void add_empty_pop_time(unsigned long t) {
     empty_pop_time += t;
@@ -163,23 +241,78 @@ template <>
 class LoopStatistics<false> {
 public:
   explicit LoopStatistics(const char* ln) {}
+  inline unsigned long lap(Timer& t) const { return 0; }
+  inline void begin_sample(Timer& t) const { }
   inline void inc_iterations(int amount = 1) const { }
   inline void inc_conflicts() const { }
   inline void add_galois_time(unsigned long t) const { }
   inline void add_user_time(unsigned long t) const { }
   inline void add_conflict_time(unsigned long t) const { }
   inline void add_push_time(unsigned long t, unsigned int n) const { }
-  inline void add_pop_time(unsigned long t) const { }
+  inline void add_pop_time(unsigned long t, unsigned int n = 1) const { }
   inline void add_empty_pop_time(unsigned long t) const { }
 };
 
+GALOIS_HAS_MEM_FUNC_ANY(pop_batch, tf_pop_batch);
+
+//! Constructs up to max items popped from wl in out; returns their number
+template<typename WL, typename T>
+unsigned popBatch(WL& wl, T* out, unsigned max, std::true_type) {
+  return wl.pop_batch(out, max);
+}
+
+template<typename WL, typename T>
+unsigned popBatch(WL& wl, T* out, unsigned max, std::false_type) {
+  unsigned n = 0;
+  Galois::optional<T> p;
+  while (n < max && (p = wl.pop()))
+    new (&out[n++]) T(*p);
+  return n;
+}
+
+template<typename WL, typename T>
+unsigned popBatch(WL& wl, T* out, unsigned max) {
+  return popBatch(wl, out, max, std::integral_constant<bool, has_tf_pop_batch<WL>::value>());
+}
+
+//! Worklists declaring tt_quiescence_termination terminate by counting
+//! pending items (see QuiescenceDetection) instead of passing a token
+GALOIS_HAS_MEM_TYPE(tt_quiescence_termination, tt_quiescence_termination);
+
+GALOIS_HAS_MEM_FUNC_ANY(peek, tf_peek);
+
+//! Stores pointers to up to max items that wl will pop next; returns their number
+template<typename WL, typename T>
+unsigned peekNext(WL& wl, const T** out, unsigned max, std::true_type) {
+  return wl.peek(out, max);
+}
+
+template<typename WL, typename T>
+unsigned peekNext(WL&, const T**, unsigned, std::false_type) {
+  return 0;
+}
+
+template<typename WL, typename T>
+unsigned peekNext(WL& wl, const T** out, unsigned max) {
+  return peekNext(wl, out, max, std::integral_constant<bool, has_tf_peek<WL>::value>());
+}
+
 template<typename value_type>
 class AbortHandler {
   struct Item { value_type val; int retries; };
 
   typedef WorkList::GFIFO<Item> AbortedList;
   PerThreadStorage<AbortedList> queues;
-  bool useBasicPolicy;
+
+  //! Selected by GALOIS_ABORT_POLICY; chosen by the number of packages
+  //! if unset
+  enum Policy { BASIC, DOUBLE, BOUNDED, EAGER, CONTENTION };
+  Policy policy;
+
+  //! Conflicts on a slot per millisecond past which items are serialized
+  static const unsigned HotConflicts = 8;
+  //! Retries past which items are serialized
+  static const int SerializeRetries = 4;
   
   /**
    * Policy: serialize via tree over packages.
@@ -241,10 +374,56 @@ class AbortHandler {
     queues.getLocal()->push(item);
   }
 
+  /**
+   * Policy: back off exponentially and retry on a thread exponentially
+   * farther away, so items that conflicted with each other spread over
+   * cores and then packages instead of piling up on leaders. Items that
+   * keep conflicting, or whose conflicting object is hot, are serialized
+   * on the thread that object hashes to.
+   */
+  void contentionPolicy(const Item& item) {
+    Lockable* lockable = getLastConflict();
+    unsigned hot = lockable ? recordConflictHotness(lockable) : 0;
+    if (hot >= HotConflicts || item.retries > SerializeRetries) {
+      queues.getRemote(lockable ? conflictOwner(lockable, activeThreads) : 0)->push(item);
+      return;
+    }
+
+    unsigned shift = item.retries - 1;
+    for (unsigned i = 0; i < (32U << shift); ++i)
+      LL::asmPause();
+    unsigned tid = LL::getTID();
+    queues.getRemote((tid + (1U << shift) - 1) % activeThreads)->push(item);
+  }
+
+  void dispatch(const Item& item) {
+    switch (policy) {
+    case BASIC: basicPolicy(item); break;
+    case DOUBLE: doublePolicy(item); break;
+    case BOUNDED: boundedPolicy(item); break;
+    case EAGER: eagerPolicy(item); break;
+    case CONTENTION: contentionPolicy(item); break;
+    }
+  }
+
 public:
   AbortHandler() {
-    // XXX(ddn): Implement smarter adaptive policy
-    useBasicPolicy = LL::getMaxPackages() > 2;
+    std::string name;
+    if (!LL::EnvCheck("GALOIS_ABORT_POLICY", name))
+      // XXX(ddn): Implement smarter adaptive policy
+      policy = LL::getMaxPackages() > 2 ? BASIC : DOUBLE;
+    else if (name == "basic")
+      policy = BASIC;
+    else if (name == "double")
+      policy = DOUBLE;
+    else if (name == "bounded")
+      policy = BOUNDED;
+    else if (name == "eager")
+      policy = EAGER;
+    else if (name == "contention")
+      policy = CONTENTION;
+    else
+      GALOIS_DIE("unknown GALOIS_ABORT_POLICY: ", name);
   }
 
   value_type& value(Item& item) const { return item.val; }
@@ -252,15 +431,15 @@ public:
 
   void push(const value_type& val) {
     Item item = { val, 1 };
-    queues.getLocal()->push(item);
+    if (policy == CONTENTION)
+      contentionPolicy(item);
+    else
+      queues.getLocal()->push(item);
   }
 
   void push(const Item& item) {
     Item newitem = { item.val, item.retries + 1 };
-    if (useBasicPolicy)
-      basicPolicy(newitem);
-    else
-      doublePolicy(newitem);
+    dispatch(newitem);
   }
 
   AbortedList* getQueue() { return queues.getLocal(); }
@@ -269,9 +448,16 @@ public:
 template<class WorkListTy, class T, class FunctionTy>
 class ForEachWork {
 protected:
+  //! Most items a batched operator receives per call
+  static const unsigned BatchSize = 64;
+  //! How many items ahead of the current one are prefetched
+  static const unsigned PrefetchDistance = 4;
+
   typedef T value_type;
   typedef typename WorkListTy::template retype<value_type>::type WLTy;
 
+  static const bool Quiescent = has_tt_quiescence_termination<WLTy>::value;
+
   struct ThreadLocalData {
     FunctionTy function;
     UserContextAccess<value_type> facing;
@@ -284,6 +470,7 @@ protected:
   // members to give higher likelihood of reclaiming PerThreadStorage
 
   AbortHandler<value_type> aborted; 
+  QuiescenceDetection& pending;
   TerminationDetection& term;
 
   WLTy wl;
@@ -291,17 +478,23 @@ protected:
   const char* loopname;
   bool broke;
 
-  inline void commitIteration(ThreadLocalData& tld) {
+  inline void commitIteration(ThreadLocalData& tld, unsigned ndone = 1) {
+    int64_t npending = -(int64_t) ndone;
     if (ForEachTraits<FunctionTy>::NeedsPush) {
       auto ii = tld.facing.getPushBuffer().begin();
       auto ee = tld.facing.getPushBuffer().end();
       if (ii != ee) {
-	tld.stat.add_galois_time(tld.facing.t.stopwatch());
+	tld.stat.add_galois_time(tld.stat.lap(tld.facing.t));
 	unsigned int npush = wl.push(ii, ee);
-	tld.stat.add_push_time(tld.facing.t.stopwatch(), npush);
+	tld.stat.add_push_time(tld.stat.lap(tld.facing.t), npush);
+	npending += tld.facing.getPushBuffer().size();
 	tld.facing.resetPushBuffer();
       }
     }
+    // Pushes are counted before the completion so the count never drops
+    // below the real number of pending items
+    if (Quiescent)
+      pending.update(npending);
     if (ForEachTraits<FunctionTy>::NeedsPIA)
       tld.facing.resetAlloc();
     if (ForEachTraits<FunctionTy>::NeedsAborts)
@@ -315,7 +508,7 @@ protected:
     tld.ctx.cancelIteration();
     tld.stat.inc_conflicts(); //Class specialization handles opt
     aborted.push(item);
-    tld.stat.add_conflict_time(tld.facing.t.stopwatch());
+    tld.stat.add_conflict_time(tld.stat.lap(tld.facing.t));
     //clear push buffer
     if (ForEachTraits<FunctionTy>::NeedsPush)
       tld.facing.resetPushBuffer();
@@ -330,13 +523,22 @@ protected:
 # endif
 #endif
 
+  //! Batched operators see a single item as a batch of one
+  void callFunction(value_type& val, ThreadLocalData& tld, std::true_type) {
+    tld.function(&val, &val + 1, tld.facing.data());
+  }
+
+  void callFunction(value_type& val, ThreadLocalData& tld, std::false_type) {
+    tld.function(val, tld.facing.data());
+  }
+
   inline void doProcess(value_type& val, ThreadLocalData& tld) {
     tld.stat.inc_iterations();
     if (ForEachTraits<FunctionTy>::NeedsAborts)
       tld.ctx.startIteration();
 
     tld.facing.u = 0;
-    tld.stat.add_galois_time(tld.facing.t.stopwatch());
+    tld.stat.add_galois_time(tld.stat.lap(tld.facing.t));
 
 #ifdef GALOIS_USE_HTM
 # ifndef GALOIS_USE_LONGJMP
@@ -345,35 +547,99 @@ protected:
 #pragma tm_atomic
     {
 #endif
-      tld.function(val, tld.facing.data());
+      callFunction(val, tld, std::integral_constant<bool, ForEachTraits<FunctionTy>::NeedsBatch>());
 #ifdef GALOIS_USE_HTM
     }
 #endif
-    tld.facing.u += tld.facing.t.stopwatch();
+    tld.facing.u += tld.stat.lap(tld.facing.t);
     tld.stat.add_user_time(tld.facing.u);
 
     clearReleasable();
     commitIteration(tld);
   }
 
-  bool runQueueSimple(ThreadLocalData& tld) {
+  void doProcessBatch(value_type* b, value_type* e, ThreadLocalData& tld) {
+    tld.stat.inc_iterations(e - b);
+    tld.facing.u = 0;
+    tld.stat.add_galois_time(tld.stat.lap(tld.facing.t));
+    tld.function(b, e, tld.facing.data());
+    tld.facing.u += tld.stat.lap(tld.facing.t);
+    tld.stat.add_user_time(tld.facing.u);
+
+    clearReleasable();
+    commitIteration(tld, e - b);
+  }
+
+  //! Prefetches the items the worklist will hand out next, skipping the
+  //! first ahead of them, which earlier calls already prefetched
+  void prefetchNext(ThreadLocalData& tld, unsigned& ahead, std::true_type) {
+    const value_type* next[PrefetchDistance];
+    unsigned n = peekNext(wl, next, PrefetchDistance);
+    for (unsigned i = std::min(ahead, n); i < n; ++i)
+      tld.function.prefetch(*next[i]);
+    ahead = n;
+  }
+
+  void prefetchNext(ThreadLocalData&, unsigned&, std::false_type) { }
+
+  void prefetchBatch(ThreadLocalData& tld, value_type* b, value_type* e, std::true_type) {
+    for (; b != e; ++b)
+      tld.function.prefetch(*b);
+  }
+
+  void prefetchBatch(ThreadLocalData&, value_type*, value_type*, std::false_type) { }
+
+  bool runQueueSimple(ThreadLocalData& tld, std::true_type) {
+    static_assert(!ForEachTraits<FunctionTy>::NeedsAborts && !ForEachTraits<FunctionTy>::NeedsBreak,
+        "batched operators must not need aborts or parallel breaks");
+    typedef typename std::aligned_storage<sizeof(value_type), std::alignment_of<value_type>::value>::type Slot;
+    Slot slots[BatchSize];
+    value_type* batch = reinterpret_cast<value_type*>(slots);
+
+    bool workHappened = false;
+    while (true) {
+      tld.stat.add_galois_time(tld.stat.lap(tld.facing.t));
+      tld.stat.begin_sample(tld.facing.t);
+      unsigned n = popBatch(wl, batch, BatchSize);
+      if (!n) {
+        tld.stat.add_empty_pop_time(tld.stat.lap(tld.facing.t));
+        break;
+      }
+      tld.stat.add_pop_time(tld.stat.lap(tld.facing.t), n);
+      workHappened = true;
+      prefetchBatch(tld, batch, batch + n, std::integral_constant<bool, ForEachTraits<FunctionTy>::NeedsPrefetch>());
+      doProcessBatch(batch, batch + n, tld);
+      for (unsigned i = 0; i < n; ++i)
+        batch[i].~value_type();
+    }
+    return workHappened;
+  }
+
+  bool runQueueSimple(ThreadLocalData& tld, std::false_type) {
+    typedef std::integral_constant<bool, ForEachTraits<FunctionTy>::NeedsPrefetch> Prefetch;
     bool workHappened = false;
-    tld.stat.add_galois_time(tld.facing.t.stopwatch());
+    unsigned ahead = 0;
+    tld.stat.add_galois_time(tld.stat.lap(tld.facing.t));
+    tld.stat.begin_sample(tld.facing.t);
     Galois::optional<value_type> p = wl.pop();
     if (p) {
-      tld.stat.add_pop_time(tld.facing.t.stopwatch());
+      tld.stat.add_pop_time(tld.stat.lap(tld.facing.t));
       workHappened = true;
     } else {
-      tld.stat.add_empty_pop_time(tld.facing.t.stopwatch());
+      tld.stat.add_empty_pop_time(tld.stat.lap(tld.facing.t));
     }
     while (p) {
+      if (ahead)
+        --ahead;
+      prefetchNext(tld, ahead, Prefetch());
       doProcess(*p, tld);
-      tld.stat.add_galois_time(tld.facing.t.stopwatch());
+      tld.stat.add_galois_time(tld.stat.lap(tld.facing.t));
+      tld.stat.begin_sample(tld.facing.t);
       p = wl.pop();
       if (p)
-        tld.stat.add_pop_time(tld.facing.t.stopwatch());
+        tld.stat.add_pop_time(tld.stat.lap(tld.facing.t));
       else
-        tld.stat.add_empty_pop_time(tld.facing.t.stopwatch());
+        tld.stat.add_empty_pop_time(tld.stat.lap(tld.facing.t));
     }
     return workHappened;
   }
@@ -381,12 +647,13 @@ protected:
   template<int limit, typename WL>
   bool runQueue(ThreadLocalData& tld, WL& lwl) {
     bool workHappened = false;
-    tld.stat.add_galois_time(tld.facing.t.stopwatch());
+    tld.stat.add_galois_time(tld.stat.lap(tld.facing.t));
+    tld.stat.begin_sample(tld.facing.t);
     Galois::optional<typename WL::value_type> p = lwl.pop();
     if (p)
-      tld.stat.add_pop_time(tld.facing.t.stopwatch());
+      tld.stat.add_pop_time(tld.stat.lap(tld.facing.t));
     else
-      tld.stat.add_empty_pop_time(tld.facing.t.stopwatch());
+      tld.stat.add_empty_pop_time(tld.stat.lap(tld.facing.t));
     unsigned num = 0;
     int result = 0;
     if (p)
@@ -403,12 +670,13 @@ protected:
 	  if (num == limit)
 	    break;
 	}
-	tld.stat.add_galois_time(tld.facing.t.stopwatch());
+	tld.stat.add_galois_time(tld.stat.lap(tld.facing.t));
+	tld.stat.begin_sample(tld.facing.t);
 	p = lwl.pop();
 	if (p)
-          tld.stat.add_pop_time(tld.facing.t.stopwatch());
+          tld.stat.add_pop_time(tld.stat.lap(tld.facing.t));
         else
-          tld.stat.add_empty_pop_time(tld.facing.t.stopwatch());
+          tld.stat.add_empty_pop_time(tld.stat.lap(tld.facing.t));
       }
 #ifdef GALOIS_USE_LONGJMP
     } else { 
@@ -440,9 +708,11 @@ protected:
   }
 
   void fastPushBack(ThreadLocalData& tld, typename UserContextAccess<value_type>::PushBufferTy& x) {
-    tld.facing.u += tld.facing.t.stopwatch();
+    tld.facing.u += tld.stat.lap(tld.facing.t);
     unsigned int npush = wl.push(x.begin(), x.end());
-    tld.stat.add_push_time(tld.facing.t.stopwatch(), npush);
+    tld.stat.add_push_time(tld.stat.lap(tld.facing.t), npush);
+    if (Quiescent)
+      pending.update(x.size());
     x.clear();
   }
 
@@ -471,28 +741,36 @@ protected:
         if (couldAbort)
           didWork |= handleAborts(tld);
       } else { // No try/catch
-        didWork = runQueueSimple(tld);
+        didWork = runQueueSimple(tld, std::integral_constant<bool, ForEachTraits<FunctionTy>::NeedsBatch>());
       }
       // Update node color and prop token
       term.localTermination(didWork);
     } while (!term.globalTermination() && (!ForEachTraits<FunctionTy>::NeedsBreak || !broke));
 
-    tld.stat.add_galois_time(tld.facing.t.stopwatch());
+    tld.stat.add_galois_time(tld.stat.lap(tld.facing.t));
     tld.facing.t.stop();
     if (couldAbort)
       setThreadContext(0);
   }
 
 public:
-  ForEachWork(FunctionTy& f, const char* l): term(getSystemTermination()), origFunction(f), loopname(l), broke(false) { }
+  ForEachWork(FunctionTy& f, const char* l):
+    pending(getQuiescenceTermination()),
+    term(Quiescent ? pending : getSystemTermination()),
+    origFunction(f), loopname(l), broke(false) { }
   
   template<typename W>
-  ForEachWork(W& w, FunctionTy& f, const char* l): term(getSystemTermination()), wl(w), origFunction(f), loopname(l), broke(false) { }
+  ForEachWork(W& w, FunctionTy& f, const char* l):
+    pending(getQuiescenceTermination()),
+    term(Quiescent ? pending : getSystemTermination()),
+    wl(w), origFunction(f), loopname(l), broke(false) { }
 
   template<typename RangeTy>
   void AddInitialWork(const RangeTy& range) {
     Timer t(true);
     int npush = wl.push_initial(range);
+    if (Quiescent)
+      pending.update(npush);
     t.stop();
     reportStat(loopname, "InitPushTime", t.get());
     reportStat(loopname, "nPushInit", npush);
@@ -503,9 +781,12 @@ public:
   }
 
   void invokeBarrier(Barrier &barrier) {
+    // Once the last barrier is passed, the master may return and destroy
+    // this object while other threads are still in after()
+    const char* ln = loopname;
     barrier.before();
     barrier();
-    barrier.after(loopname);
+    barrier.after(ln);
   }
 
   void operator()() {
@@ -29,6 +29,8 @@
 
 namespace Galois {
 class Statistic;
+class Histogram;
+struct Log2Histogram;
 }
 
 namespace Galois {
@@ -47,7 +49,18 @@ void reportPageAlloc(const char* category);
 //! Reports NUMA memory stats for all NUMA nodes
 void reportNumaAlloc(const char* category);
 
-//! Prints all stats
+//! Adds to the histogram of the calling thread
+void reportHistogram(const char* loopname, const char* category, const Galois::Log2Histogram& value);
+//! Reports histograms for all threads
+void reportHistogram(Galois::Histogram* value);
+//! Appends a timestamped sample to a time series of the calling thread
+void reportSample(const char* loopname, const char* category, unsigned long value);
+//! Whether time series are recorded and the time next (in microseconds
+//! since startup) has passed; if so, next is advanced by one interval
+bool sampleDue(unsigned long& next);
+
+//! Prints all stats, and writes them with histograms and time series to
+//! GALOIS_STATS_OUT.json and GALOIS_STATS_OUT-*.csv if it is set
 void printStats();
 
 }
@@ -33,6 +33,9 @@
 #include "Galois/Runtime/PerThreadStorage.h"
 #include "Galois/Runtime/ll/CacheLineStorage.h"
 
+#include <atomic>
+#include <stdint.h>
+
 namespace Galois {
 namespace Runtime {
 
@@ -66,9 +69,66 @@ public:
   }
 };
 
+/**
+ * Termination by counting pending work instead of circulating a token.
+ *
+ * The executor reports every change in the number of items pushed but not
+ * yet completed through update(). Threads accumulate these locally and
+ * fold them into a global word every FoldInterval updates and whenever
+ * they find no work. The same word counts the busy threads: a thread is
+ * busy from initializeThread() or its first update() until it finds no
+ * work, so every thread that has not folded its changes is counted.
+ * Termination is declared as soon as the word reads zero, and idle
+ * threads back off instead of polling the worklist continuously.
+ */
+class QuiescenceDetection : public TerminationDetection {
+  static const int64_t Busy = int64_t(1) << 40;
+  static const unsigned FoldInterval = 64;
+  static const unsigned MaxBackoff = 1024;
+
+  struct ThreadState {
+    int64_t delta;
+    unsigned updates;
+    unsigned backoff;
+    bool idle;
+  };
+
+  LL::CacheLineStorage<std::atomic<int64_t> > word;
+  PerThreadStorage<ThreadState> state;
+
+  void fold(ThreadState& s, int64_t busy) {
+    word.data.fetch_add(s.delta + busy);
+    s.delta = 0;
+    s.updates = 0;
+  }
+
+public:
+  QuiescenceDetection() { word.data = 0; }
+
+  //! Records that the number of pending items changed by d
+  void update(int64_t d) {
+    ThreadState& s = *state.getLocal();
+    if (s.idle) {
+      s.idle = false;
+      s.backoff = 1;
+      word.data.fetch_add(Busy);
+    }
+    s.delta += d;
+    if (++s.updates >= FoldInterval)
+      fold(s, 0);
+  }
+
+  virtual void initializeThread();
+  virtual void localTermination(bool workHappened);
+  virtual long getEpoch() const { return 0; }
+};
+
 //returns an object.  The object will be reused.
 TerminationDetection& getSystemTermination();
 
+//! Quiescence detection object shared by loops that use it
+QuiescenceDetection& getQuiescenceTermination();
+
 } // end namespace Runtime
 } // end namespace Galois
 
@@ -23,6 +23,8 @@
 #ifndef GALOIS_RUNTIME_LL_ENVCHECK_H
 #define GALOIS_RUNTIME_LL_ENVCHECK_H
 
+#include <string>
+
 namespace Galois {
 namespace Runtime {
 namespace LL {
@@ -30,7 +32,11 @@ namespace LL {
 //PLEASE document all enviroment variables here;
 //ThreadPool_pthread.cpp: "GALOIS_DO_NOT_BIND_MAIN_THREAD"
 //ThreadPool_pthread.cpp: "GALOIS_DO_NOT_BIND_THREADS"
+//ThreadPool_pthread.cpp: "GALOIS_POOL_SPIN"
+//ParallelWork.h: "GALOIS_ABORT_POLICY"
 //HWTopoLinux.cpp: "GALOIS_DEBUG_TOPO"
+//Support.cpp: "GALOIS_STATS_OUT"
+//Support.cpp: "GALOIS_STATS_INTERVAL"
 //Sampling.cpp: "GALOIS_EXIT_BEFORE_SAMPLING"
 //Sampling.cpp: "GALOIS_EXIT_AFTER_SAMPLING"
 //gIO.cpp: "GALOIS_DEBUG_TO_FILE"
@@ -39,6 +45,7 @@ namespace LL {
 //! Return true if the Enviroment variable is set
 bool EnvCheck(const char* parm);
 bool EnvCheck(const char* parm, int& val);
+bool EnvCheck(const char* parm, std::string& val);
 
 }
 }
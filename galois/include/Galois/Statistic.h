@@ -31,6 +31,8 @@
 
 #include "boost/utility.hpp"
 
+#include <algorithm>
+
 #include GALOIS_CXX11_STD_HEADER(deque)
 
 namespace Galois {
@@ -81,6 +83,83 @@ public:
   }
 };
 
+/**
+ * Counts of values by power of two seen by one thread. Bucket 0 counts
+ * zeros and bucket i > 0 counts values in [2^(i-1), 2^i).
+ */
+struct Log2Histogram {
+  static const unsigned NumBuckets = 65;
+  unsigned long counts[NumBuckets];
+
+  Log2Histogram() { std::fill(counts, counts + NumBuckets, 0); }
+
+  void add(unsigned long v) {
+    ++counts[v ? 64 - __builtin_clzl(v) : 0];
+  }
+};
+
+/**
+ * Per-thread histogram. Like Statistic, it reports itself when destroyed.
+ * Histograms are only written to the files named by GALOIS_STATS_OUT.
+ */
+class Histogram {
+  std::string statname;
+  std::string loopname;
+  Galois::Runtime::PerThreadStorage<Log2Histogram> val;
+  bool valid;
+
+public:
+  Histogram(const std::string& _sn, std::string _ln = "(NULL)"): statname(_sn), loopname(_ln), valid(true) { }
+
+  ~Histogram() {
+    report();
+  }
+
+  //! Adds histogram to stat pool, usually deconsructor calls this for you.
+  void report() {
+    if (valid)
+      Galois::Runtime::reportHistogram(this);
+    valid = false;
+  }
+
+  const Log2Histogram& getValue(unsigned tid) {
+    return *val.getRemote(tid);
+  }
+
+  std::string& getLoopname() {
+    return loopname;
+  }
+
+  std::string& getStatname() {
+    return statname;
+  }
+
+  void add(unsigned long v) {
+    val.getLocal()->add(v);
+  }
+};
+
+/**
+ * Paces the samples one thread takes of time series: due() is true at most
+ * once every GALOIS_STATS_INTERVAL microseconds, and never if it is unset.
+ * The clock is only read once per checkPeriod calls.
+ */
+class SamplePacer {
+  unsigned long next;
+  unsigned checkPeriod;
+  unsigned countdown;
+
+public:
+  explicit SamplePacer(unsigned p = 256): next(0), checkPeriod(p), countdown(p) { }
+
+  bool due() {
+    if (--countdown)
+      return false;
+    countdown = checkPeriod;
+    return Galois::Runtime::sampleDue(next);
+  }
+};
+
 /**
  * Controls lifetime of stats. Users usually instantiate in main to print out
  * statistics at program exit.
@@ -129,6 +129,25 @@ GALOIS_HAS_MEM_FUNC_ANY(galoisDeterministicId, tf_deterministic_id);
 template<typename T>
 struct has_deterministic_id : public has_tf_deterministic_id<T> {};
 
+GALOIS_HAS_MEM_FUNC_ANY(prefetch, tf_prefetch);
+/**
+ * Indicates the operator has a member function that starts loading the data
+ * an item will touch. The executor calls it on items a few pops ahead of
+ * the one being processed, as far as the worklist can tell which items come
+ * next.
+ *
+ * The type conforms to the following:
+ * \code
+ *  struct T {
+ *    void prefetch(const A& item) {
+ *      // e.g., __builtin_prefetch(&graph.getData(item.n, Galois::MethodFlag::NONE))
+ *    }
+ *  };
+ * \endcode
+ */
+template<typename T>
+struct has_prefetch : public has_tf_prefetch<T> {};
+
 GALOIS_HAS_MEM_TYPE(GaloisDeterministicLocalState, tf_deterministic_local_state);
 /**
  * Indicates the operator has a member type that encapsulates state that is passed between 
@@ -170,6 +189,21 @@ BOOST_MPL_HAS_XXX_TRAIT_DEF(tt_needs_parallel_break)
 template<typename T>
 struct needs_parallel_break : public has_tt_needs_parallel_break<T> {};
 
+/**
+ * Indicates the operator processes a batch of items per call. The executor
+ * pops up to a chunk of items at once (see the pop_batch worklist method)
+ * and calls
+ * \code
+ *  void operator()(T* begin, T* end, Galois::UserContext<T>& ctx);
+ * \endcode
+ * Items pushed to ctx are added to the worklist after the call returns.
+ * Batched operators must also declare tt_does_not_need_aborts and may not
+ * declare tt_needs_parallel_break.
+ */
+BOOST_MPL_HAS_XXX_TRAIT_DEF(tt_needs_batch)
+template<typename T>
+struct needs_batch : public has_tt_needs_batch<T> {};
+
 /**
  * Indicates the operator does not generate new work and push it on the worklist
  */
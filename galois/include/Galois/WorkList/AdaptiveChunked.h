@@ -0,0 +1,368 @@
+/** Chunked worklists with runtime chunk sizes -*- C++ -*-
+ * @file
+ * @section License
+ *
+ * Galois, a framework to exploit amorphous data-parallelism in irregular
+ * programs.
+ *
+ * Copyright (C) 2013, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ *
+ * @section Description
+ *
+ * Chunked worklists whose threads pick the size of the chunks they fill
+ * at runtime instead of through a template argument.
+ */
+#ifndef GALOIS_WORKLIST_ADAPTIVECHUNKED_H
+#define GALOIS_WORKLIST_ADAPTIVECHUNKED_H
+
+#include "Galois/optional.h"
+#include "Galois/WorkList/Chunked.h"
+#include "Galois/WorkList/WorkListHelpers.h"
+#include "WLCompileCheck.h"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+namespace Galois {
+namespace WorkList {
+
+namespace detail {
+
+//! A ring whose capacity, a power of two, is chosen when it is allocated.
+//! The items follow the header in the same allocation.
+template<typename T, template<typename, bool> class QT, bool Concurrent>
+class DynChunk : public QT<DynChunk<T, QT, Concurrent>, Concurrent>::ListNode {
+  unsigned mask;
+  unsigned start;
+  unsigned count;
+  unsigned cls;
+
+  T* at(unsigned i) { return reinterpret_cast<T*>(this + 1) + ((start + i) & mask); }
+
+public:
+  static size_t bytes(unsigned cap) { return sizeof(DynChunk) + cap * sizeof(T); }
+
+  DynChunk(unsigned c, unsigned cap): mask(cap - 1), start(0), count(0), cls(c) {
+    static_assert(std::alignment_of<T>::value <= std::alignment_of<DynChunk>::value, "item alignment");
+  }
+
+  ~DynChunk() {
+    while (count)
+      extract_front();
+  }
+
+  unsigned sizeClass() const { return cls; }
+  bool empty() const { return count == 0; }
+  unsigned size() const { return count; }
+  T& operator[](unsigned i) { return *at(i); }
+  T& front() { return *at(0); }
+  T& back() { return *at(count - 1); }
+
+  template<typename... Args>
+  T* emplace_back(Args&&... args) {
+    if (count > mask)
+      return 0;
+    T* p = new (at(count)) T(std::forward<Args>(args)...);
+    ++count;
+    return p;
+  }
+
+  void pop_front() {
+    at(0)->~T();
+    start = (start + 1) & mask;
+    --count;
+  }
+
+  void pop_back() {
+    at(count - 1)->~T();
+    --count;
+  }
+
+  Galois::optional<T> extract_front() {
+    Galois::optional<T> retval;
+    if (count) {
+      retval = *at(0);
+      pop_front();
+    }
+    return retval;
+  }
+
+  Galois::optional<T> extract_back() {
+    Galois::optional<T> retval;
+    if (count) {
+      retval = *at(count - 1);
+      pop_back();
+    }
+    return retval;
+  }
+};
+
+constexpr unsigned chunkSizeClasses(int n) {
+  return n <= 1 ? 1 : 1 + chunkSizeClasses(n / 2);
+}
+
+} // end namespace detail
+
+/**
+ * Chunked worklist in which every thread sizes the chunks it fills.
+ * Capacities are powers of two up to MaxChunkSize. Each capacity has its
+ * own allocator.
+ *
+ * Threads start at MaxChunkSize. Every AdaptPeriod pops, a thread compares
+ * what it saw over the period:
+ * <ul>
+ *  <li>if more than 1/16 of its chunk requests found every queue empty
+ *  (work is stuck in other threads' partial chunks) or more than 1/8 of its
+ *  pops were reported as wasted work through OBIMDeltaFeedback (priority
+ *  inversion), it halves its chunk size;</li>
+ *  <li>otherwise, if it pushed and popped chunks more than GrowRate times
+ *  per millisecond, it doubles its chunk size to take traffic off the chunk
+ *  queues.</li>
+ * </ul>
+ *
+ * A fine-grained loop such as SSSP then settles on small chunks, and a
+ * coarse-grained one such as DMR keeps large ones.
+ */
+template<typename T, template<typename, bool> class QT, bool Distributed, template<typename> class DistStore, bool IsStack, int MaxChunkSize, bool Concurrent>
+struct AdaptiveChunkedMaster : private boost::noncopyable {
+  template<bool _concurrent>
+  struct rethread { typedef AdaptiveChunkedMaster<T, QT, Distributed, DistStore, IsStack, MaxChunkSize, _concurrent> type; };
+
+  template<typename _T>
+  struct retype { typedef AdaptiveChunkedMaster<_T, QT, Distributed, DistStore, IsStack, MaxChunkSize, Concurrent> type; };
+
+  template<int _chunk_size>
+  struct with_chunk_size { typedef AdaptiveChunkedMaster<T, QT, Distributed, DistStore, IsStack, _chunk_size, Concurrent> type; };
+
+  template<template<typename, bool> class _qt>
+  struct with_chunk_queue { typedef AdaptiveChunkedMaster<T, _qt, Distributed, DistStore, IsStack, MaxChunkSize, Concurrent> type; };
+
+private:
+  static const unsigned NumClasses = detail::chunkSizeClasses(MaxChunkSize);
+  static const unsigned AdaptPeriod = 256;
+  static const unsigned long GrowRate = 1000;
+
+  typedef detail::DynChunk<T, QT, Concurrent> Chunk;
+  typedef QT<Chunk, Concurrent> LevelItem;
+  typedef std::chrono::steady_clock clockTy;
+
+  struct p {
+    Chunk* cur;
+    Chunk* next;
+    p(): cur(0), next(0) { }
+  };
+
+  //! Per-thread chunk sizing, shared by all instances (e.g., OBIM buckets)
+  struct Adapt {
+    unsigned cls;
+    unsigned pops;
+    unsigned chunkOps;
+    unsigned failedSteals;
+    unsigned long lastWasted;
+    clockTy::time_point periodStart;
+    Adapt(): cls(NumClasses - 1), pops(0), chunkOps(0), failedSteals(0), lastWasted(0) { }
+  };
+
+  static Adapt& adaptState() {
+    static Runtime::PerThreadStorage<Adapt> a;
+    return *a.getLocal();
+  }
+
+  std::vector<Runtime::MM::FixedSizeAllocator> heaps;
+  squeue<Concurrent, Runtime::PerThreadStorage, p> data;
+  squeue<Distributed, DistStore, LevelItem> Q;
+
+  Chunk* mkChunk(unsigned cls) {
+    return new (heaps[cls].allocate(Chunk::bytes(1u << cls))) Chunk(cls, 1u << cls);
+  }
+
+  void delChunk(Chunk* C) {
+    unsigned cls = C->sizeClass();
+    C->~Chunk();
+    heaps[cls].deallocate(C);
+  }
+
+  void pushChunk(Chunk* C) {
+    ++adaptState().chunkOps;
+    Q.get().push(C);
+  }
+
+  Chunk* popChunk() {
+    Adapt& a = adaptState();
+    int id = Q.myEffectiveID();
+    Chunk* r = Q.get(id).pop();
+    for (int i = id + 1; !r && i < (int) Q.size(); ++i)
+      r = Q.get(i).pop();
+    for (int i = 0; !r && i < id; ++i)
+      r = Q.get(i).pop();
+    if (r)
+      ++a.chunkOps;
+    else
+      ++a.failedSteals;
+    return r;
+  }
+
+  static void adapt(Adapt& a) {
+    clockTy::time_point now = clockTy::now();
+    unsigned long usec = std::chrono::duration_cast<std::chrono::microseconds>(now - a.periodStart).count();
+    unsigned long total = *OBIMDeltaFeedback::counters().getLocal();
+    unsigned long wasted = total - a.lastWasted;
+
+    if (a.periodStart != clockTy::time_point()) {
+      if (a.failedSteals * 16 > a.pops || wasted * 8 > a.pops) {
+        if (a.cls > 0)
+          --a.cls;
+      } else if (a.cls + 1 < NumClasses && a.chunkOps * 1000 > GrowRate * usec) {
+        ++a.cls;
+      }
+    }
+
+    a.periodStart = now;
+    a.lastWasted = total;
+    a.pops = a.chunkOps = a.failedSteals = 0;
+  }
+
+  template<typename... Args>
+  T* emplacei(p& n, Args&&... args) {
+    T* retval = 0;
+    if (n.next && (retval = n.next->emplace_back(std::forward<Args>(args)...)))
+      return retval;
+    if (n.next)
+      pushChunk(n.next);
+    unsigned cls = adaptState().cls;
+    Chunk* c = mkChunk(cls);
+    retval = c->emplace_back(std::forward<Args>(args)...);
+    if (cls == 0) {
+      pushChunk(c);
+      n.next = 0;
+    } else {
+      n.next = c;
+    }
+    assert(retval);
+    return retval;
+  }
+
+  Chunk*& popTarget(p& n) {
+    return IsStack ? n.next : n.cur;
+  }
+
+public:
+  typedef T value_type;
+
+  AdaptiveChunkedMaster() {
+    for (unsigned i = 0; i < NumClasses; ++i)
+      heaps.emplace_back(Chunk::bytes(1u << i));
+  }
+
+  AdaptiveChunkedMaster(int) : AdaptiveChunkedMaster() { }
+
+  void flush() {
+    p& n = data.get();
+    if (n.next)
+      pushChunk(n.next);
+    n.next = 0;
+  }
+
+  void push(const value_type& val) {
+    p& n = data.get();
+    emplacei(n, val);
+  }
+
+  template<typename Iter>
+  unsigned int push(Iter b, Iter e) {
+    p& n = data.get();
+    int npush;
+    for (npush = 0; b != e; npush++)
+      emplacei(n, *b++);
+    return npush;
+  }
+
+  template<typename RangeTy>
+  unsigned int push_initial(const RangeTy& range) {
+    auto rp = range.local_pair();
+    return push(rp.first, rp.second);
+  }
+
+  //! Pop up to max items from one chunk into uninitialized storage at out
+  unsigned peek(const value_type** out, unsigned max) {
+    Chunk* C = popTarget(data.get());
+    if (!C)
+      return 0;
+    unsigned num = std::min(max, C->size());
+    for (unsigned i = 0; i < num; ++i)
+      out[i] = &(*C)[IsStack ? C->size() - 1 - i : i];
+    return num;
+  }
+
+  unsigned pop_batch(value_type* out, unsigned max) {
+    Galois::optional<value_type> retval = pop();
+    if (!retval)
+      return 0;
+    new (out) value_type(*retval);
+    Chunk* C = popTarget(data.get());
+    unsigned num = 1;
+    while (num < max && (retval = IsStack ? C->extract_back() : C->extract_front()))
+      new (&out[num++]) value_type(*retval);
+    adaptState().pops += num - 1;
+    return num;
+  }
+
+  Galois::optional<value_type> pop() {
+    p& n = data.get();
+    Adapt& a = adaptState();
+    if (++a.pops >= AdaptPeriod)
+      adapt(a);
+
+    Chunk*& C = popTarget(n);
+    Galois::optional<value_type> retval;
+    if (C && (retval = IsStack ? C->extract_back() : C->extract_front()))
+      return retval;
+    if (C)
+      delChunk(C);
+    C = popChunk();
+    if (!IsStack && !C) {
+      C = n.next;
+      n.next = 0;
+    }
+    if (C)
+      retval = IsStack ? C->extract_back() : C->extract_front();
+    return retval;
+  }
+};
+
+/**
+ * Distributed chunked FIFO with chunk sizes chosen at runtime. See
+ * {@link AdaptiveChunkedMaster}.
+ *
+ * @tparam MaxChunkSize largest chunk size
+ */
+template<int MaxChunkSize=64, typename T = int, bool Concurrent=true>
+class dAdaptiveChunkedFIFO : public AdaptiveChunkedMaster<T, ConExtLinkedQueue, true, Runtime::PerPackageStorage, false, MaxChunkSize, Concurrent> {};
+GALOIS_WLCOMPILECHECK(dAdaptiveChunkedFIFO)
+
+/**
+ * Distributed chunked LIFO with chunk sizes chosen at runtime. See
+ * {@link AdaptiveChunkedMaster}.
+ *
+ * @tparam MaxChunkSize largest chunk size
+ */
+template<int MaxChunkSize=64, typename T = int, bool Concurrent=true>
+class dAdaptiveChunkedLIFO : public AdaptiveChunkedMaster<T, ConExtLinkedStack, true, Runtime::PerPackageStorage, true, MaxChunkSize, Concurrent> {};
+GALOIS_WLCOMPILECHECK(dAdaptiveChunkedLIFO)
+
+} // end namespace WorkList
+} // end namespace Galois
+
+#endif
@@ -29,6 +29,7 @@
 #include "Galois/Runtime/ll/CompilerSpecific.h"
 #include "Galois/Runtime/ll/PtrLock.h"
 #include "Galois/Runtime/mm/Mem.h"
+#include "Galois/WorkList/WorkListHelpers.h"
 #include "WLCompileCheck.h"
 
 namespace Galois {
@@ -37,6 +38,8 @@ namespace WorkList {
 struct ChunkHeader {
   ChunkHeader* next;
   ChunkHeader* prev;
+
+  ChunkHeader*& getNext() { return next; }
 };
 
 #if 0
@@ -305,6 +308,46 @@ public:
   }
 };
 
+//! Per-thread chunk queue on a lock-free ring; thieves move chunks one at a time
+class AltChunkedRing {
+  ConExtRingQueue<ChunkHeader, true> q;
+
+  ChunkHeader* stealAndPop(AltChunkedRing& victim, size_t n) {
+    ChunkHeader* retval = victim.q.pop();
+    if (!retval) return 0;
+    for (; n > 1; --n) {
+      ChunkHeader* C = victim.q.pop();
+      if (!C) break;
+      q.push(C);
+    }
+    return retval;
+  }
+
+public:
+  bool empty() const {
+    return q.empty();
+  }
+
+  void push(ChunkHeader* obj) {
+    q.push(obj);
+  }
+
+  ChunkHeader* pop() {
+    return q.pop();
+  }
+
+  ChunkHeader* stealAllAndPop(AltChunkedRing& victim) {
+    //Don't do work on empty victims (lockfree check)
+    if (victim.empty()) return 0;
+    return stealAndPop(victim, victim.q.ringSize());
+  }
+
+  ChunkHeader* stealHalfAndPop(AltChunkedRing& victim) {
+    if (victim.empty()) return 0;
+    return stealAndPop(victim, (victim.q.ringSize() + 1) / 2);
+  }
+};
+
 template<typename InnerWL>
 class StealingQueue : private boost::noncopyable {
   Runtime::PerThreadStorage<std::pair<InnerWL, unsigned> > local;
@@ -481,6 +524,10 @@ template<int ChunkSize=64, typename T = int>
 class AltChunkedFIFO : public AltChunkedMaster<false, ChunkSize, StealingQueue<AltChunkedQueue>, T> {};
 GALOIS_WLCOMPILECHECK(AltChunkedFIFO)
 
+template<int ChunkSize=64, typename T = int>
+class AltChunkedRingFIFO : public AltChunkedMaster<false, ChunkSize, StealingQueue<AltChunkedRing>, T> {};
+GALOIS_WLCOMPILECHECK(AltChunkedRingFIFO)
+
 } // end namespace
 } // end namespace
 #endif
@@ -75,6 +75,10 @@ struct ChunkedMaster : private boost::noncopyable {
   template<int _chunk_size>
   struct with_chunk_size { typedef ChunkedMaster<T, QT, Distributed, DistStore, IsStack, _chunk_size, Concurrent> type; };
 
+  //! Replaces the queue of full chunks, e.g., with ConExtRingQueue
+  template<template<typename, bool> class _qt>
+  struct with_chunk_queue { typedef ChunkedMaster<T, _qt, Distributed, DistStore, IsStack, ChunkSize, Concurrent> type; };
+
 private:
   class Chunk : public FixedSizeRing<T, ChunkSize>, public QT<Chunk, Concurrent>::ListNode {};
 
@@ -158,8 +162,11 @@ public:
 
 #ifdef PER_CHUNK_STATS
   Statistic *qPopFast, *qPopFastCyc, *qPopLocal, *qPopLocalCyc, *qPopRemote, *qPopRemoteCyc, *qEmpty, *qEmptyCyc;
+  //! Number of items in chunks taken from the shared queues
+  Histogram* qChunkFill;
 #else
   static Statistic *qPopFast, *qPopFastCyc, *qPopLocal, *qPopLocalCyc, *qPopRemote, *qPopRemoteCyc, *qEmpty, *qEmptyCyc;
+  static Histogram* qChunkFill;
   static Runtime::LL::SimpleLock<true> statLock;
 #endif
 
@@ -179,6 +186,7 @@ public:
       qPopRemoteCyc = new Statistic("qPopRemoteCyc", id);
       qEmpty = new Statistic("qPopEmpty", id);
       qEmptyCyc = new Statistic("qPopEmptyCyc", id);
+      qChunkFill = new Histogram("qChunkFill", id);
 #ifndef PER_CHUNK_STATS
     }
     statLock.unlock();
@@ -215,6 +223,7 @@ public:
       delete qPopRemoteCyc; qPopRemoteCyc = 0;
       delete qEmpty; qEmpty = 0;
       delete qEmptyCyc; qEmptyCyc = 0;
+      delete qChunkFill; qChunkFill = 0;
 #ifndef PER_CHUNK_STATS
     }
     statLock.unlock();
@@ -310,6 +319,39 @@ public:
     return push(rp.first, rp.second);
   }
 
+  /**
+   * Pop up to max items into uninitialized storage at out and return their
+   * number. Items after the first come from the same chunk.
+   */
+  unsigned peek(const value_type** out, unsigned max) {
+    p& n = data.get();
+    Chunk* C = IsStack ? n.next : n.cur;
+    unsigned num = 0;
+    if (!C)
+      return 0;
+    if (IsStack) {
+      for (auto ii = C->rbegin(), ei = C->rend(); ii != ei && num < max; ++ii)
+        out[num++] = &*ii;
+    } else {
+      for (auto ii = C->begin(), ei = C->end(); ii != ei && num < max; ++ii)
+        out[num++] = &*ii;
+    }
+    return num;
+  }
+
+  unsigned pop_batch(value_type* out, unsigned max) {
+    Galois::optional<value_type> retval = pop();
+    if (!retval)
+      return 0;
+    new (out) value_type(*retval);
+    p& n = data.get();
+    Chunk* C = IsStack ? n.next : n.cur;
+    unsigned num = 1;
+    while (num < max && (retval = IsStack ? C->extract_back() : C->extract_front()))
+      new (&out[num++]) value_type(*retval);
+    return num;
+  }
+
   Galois::optional<value_type> pop() {
     Timer tt(true);
     p& n = data.get();
@@ -325,6 +367,7 @@ public:
 	delChunk(n.next);
       n.next = popChunk(local);
       if (n.next) {
+        qChunkFill->add(n.next->size());
 	retval = n.next->extract_back();
         if (local) {
           *qPopLocal += 1;
@@ -347,6 +390,8 @@ public:
       if (n.cur)
 	delChunk(n.cur);
       n.cur = popChunk(local);
+      if (n.cur)
+        qChunkFill->add(n.cur->size());
       if (!n.cur) {
 	n.cur = n.next;
 	n.next = 0;
@@ -396,6 +441,9 @@ Runtime::LL::SimpleLock<true> ChunkedMaster<T, QT, Distributed, DistStore, IsSta
 
 template<typename T, template<typename, bool> class QT, bool Distributed, template<typename> class DistStore, bool IsStack, int ChunkSize, bool Concurrent>
 Statistic* ChunkedMaster<T, QT, Distributed, DistStore, IsStack, ChunkSize, Concurrent>::qEmptyCyc;
+
+template<typename T, template<typename, bool> class QT, bool Distributed, template<typename> class DistStore, bool IsStack, int ChunkSize, bool Concurrent>
+Histogram* ChunkedMaster<T, QT, Distributed, DistStore, IsStack, ChunkSize, Concurrent>::qChunkFill;
 #endif
 
 /**
@@ -28,11 +28,14 @@
 #include "Galois/Timer.h"
 #include "Galois/Statistic.h"
 #include "Galois/Runtime/PerThreadStorage.h"
+#include "Galois/Runtime/ll/CacheLineStorage.h"
 #include "Galois/WorkList/Fifo.h"
 #include "Galois/WorkList/WorkListHelpers.h"
 
 #include GALOIS_CXX11_STD_HEADER(type_traits)
+#include <atomic>
 #include <limits>
+#include <vector>
 
 #include <iostream>
 
@@ -61,6 +64,10 @@ namespace WorkList {
  * @tparam Container Scheduler for each bucket
  * @tparam BlockPeriod Check for higher priority work every 2^BlockPeriod
  *                     iterations
+ * Each thread has its own OBIM. A thread out of work steals from another
+ * one, chosen as the better of two random threads by the best priority each
+ * publishes; it takes up to half of the victim's best bucket at once.
+ *
  * @tparam BSP Use back-scan prevention
  */
 template<class Indexer = DummyIndexer<int>, typename Container = FIFO<>,
@@ -88,26 +95,49 @@ struct dOrderedByIntegerMetric : private boost::noncopyable {
 private:
   typedef typename Container::template rethread<false>::type CTy;
 
-  typedef Galois::flat_map<Index, CTy*> LMapTy;
-  //typedef std::map<Index, CTy*> LMapTy;
+  //! Most items taken from a victim's bucket at once
+  static const unsigned int StealMax = 64;
+
+  struct Bucket {
+    CTy queue;
+    unsigned int size;
+
+    Bucket(Index i): queue(i), size(0) { }
+  };
+
+  typedef Galois::flat_map<Index, Bucket*> LMapTy;
+  //typedef std::map<Index, Bucket*> LMapTy;
+
+  //! What thieves look at to choose a victim; kept on its own cache line
+  //! so that reading it does not disturb the owner's perItem
+  struct Summary {
+    std::atomic<Index> best;
+    std::atomic<unsigned int> size;
+
+    Summary(): best(std::numeric_limits<Index>::max()), size(0) { }
+  };
 
   struct perItem {
     LMapTy local;
     Runtime::LL::PaddedLock<true> lock;
     Index curIndex;
     Index scanStart;
-    CTy* current;
+    Bucket* current;
     unsigned int numPops;
+    unsigned int size;
+    Summary* summary;
+    std::vector<T> stolen;
 
     perItem() :
       curIndex(std::numeric_limits<Index>::min()), 
       scanStart(std::numeric_limits<Index>::min()),
-      current(0), numPops(0) { }
+      current(0), numPops(0), size(0), summary(0) { }
   };
 
   // NB: Place dynamically growing masterLog after fixed-size PerThreadStorage
   // members to give higher likelihood of reclaiming PerThreadStorage
   Runtime::PerThreadStorage<perItem> current;
+  Runtime::PerThreadStorage<Runtime::LL::CacheLineStorage<Summary> > summaries;
   Galois::Timer clock;
 
   Runtime::MM::FixedSizeAllocator heap;
@@ -120,13 +150,29 @@ private:
     }
   };
 
+  //! Requires p->lock
+  void publish(perItem* p) {
+    Index best = p->size ? p->scanStart : std::numeric_limits<Index>::max();
+    if (p->summary->best.load(std::memory_order_relaxed) != best)
+      p->summary->best.store(best, std::memory_order_relaxed);
+    if (p->summary->size.load(std::memory_order_relaxed) != p->size)
+      p->summary->size.store(p->size, std::memory_order_relaxed);
+  }
+
+  Summary* summaryOf(int q) { return &summaries.getRemote(q)->data; }
+
+  Index bestOf(int q) {
+    Summary* s = summaryOf(q);
+    return s->size.load(std::memory_order_relaxed) ? s->best.load(std::memory_order_relaxed) : std::numeric_limits<Index>::max();
+  }
+
   GALOIS_ATTRIBUTE_NOINLINE
   Galois::optional<T> globalPop() {
     unsigned tid = Galois::Runtime::LL::getTID();
 
     for (int i = 1; i < nQ; i++) {
       Galois::optional<T> rv;
-      if (rv = slowPop(current.getRemote((tid + i) % nQ), false))
+      if (rv = steal((tid + i) % nQ))
         return rv;
     }
     return Galois::optional<value_type>();
@@ -137,23 +183,19 @@ private:
     while (true) {
       int q0 = LockFreeSkipList<Comparer, Index>::rand_range(nQ) - 1;
       int q1 = LockFreeSkipList<Comparer, Index>::rand_range(nQ) - 1;
-      perItem *p0 = current.getRemote(q0);
-      perItem *p1 = current.getRemote(q1);
       Galois::optional<T> rv;
  
       if (q0 >= nQ || q1 >= nQ) abort();
 
-      if (p0->scanStart == std::numeric_limits<Index>::max() && 
-          p1->scanStart == std::numeric_limits<Index>::max()) {
+      Index b0 = bestOf(q0);
+      Index b1 = bestOf(q1);
+      if (b0 == std::numeric_limits<Index>::max() && 
+          b1 == std::numeric_limits<Index>::max()) {
         break;
-      } else if (p0->scanStart == std::numeric_limits<Index>::max()) {
-        rv = slowPop(p1, false);
-      } else if (p1->scanStart == std::numeric_limits<Index>::max()) {
-        rv = slowPop(p0, false);
-      } else if (p0->scanStart < p1->scanStart) {
-        rv = slowPop(p0, false);
+      } else if (b0 < b1) {
+        rv = steal(q0);
       } else {
-        rv = slowPop(p1, false);
+        rv = steal(q1);
       }
       if (rv)
         return rv;
@@ -161,47 +203,115 @@ private:
     return globalPop();
   }
 
-  GALOIS_ATTRIBUTE_NOINLINE
-  Galois::optional<T> slowPop(perItem* p, bool local) {
+  //! Requires p->lock
+  Galois::optional<T> popBucket(perItem* p, Bucket* b) {
+    Galois::optional<T> retval = b->queue.pop();
+    if (retval) {
+      --b->size;
+      --p->size;
+    }
+    return retval;
+  }
 
+  //! Requires p->lock
+  GALOIS_ATTRIBUTE_NOINLINE
+  Galois::optional<T> slowPop(perItem* p) {
     Index msS = p->scanStart;
     if (msS == std::numeric_limits<Index>::max())
       return Galois::optional<value_type>();
 
-    if (!local)
-      p->lock.lock();
-
     for (auto ii = p->local.lower_bound(msS), ee = p->local.end(); ii != ee; ++ii) {
       Galois::optional<T> retval;
-      if ((retval = ii->second->pop())) {
-        if (!local) {
-          p->lock.unlock();
-        } else {
-          p->current = ii->second;
-          p->curIndex = ii->first;
-          p->scanStart = ii->first;
-        }
+      if ((retval = popBucket(p, ii->second))) {
+        p->current = ii->second;
+        p->curIndex = ii->first;
+        p->scanStart = ii->first;
+        publish(p);
         return retval;
       }
     }
     // nothing found, fail fast in future searches 
     p->scanStart = std::numeric_limits<Index>::max();
-    if (!local)
-      p->lock.unlock();
+    publish(p);
 
     return Galois::optional<value_type>();
   }
 
-  inline CTy* updateLocalOrCreate(perItem* p, Index i) {
+  /**
+   * Takes half of the victim's best bucket, but at most StealMax items, in
+   * one critical section on the victim; all but one of them are added to
+   * our own bucket of the same priority.
+   */
+  GALOIS_ATTRIBUTE_NOINLINE
+  Galois::optional<T> steal(int q) {
+    perItem* p = current.getLocal();
+    perItem* v = current.getRemote(q);
+    Galois::optional<T> retval;
+
+    if (v == p) {
+      p->lock.lock();
+      retval = slowPop(p);
+      p->lock.unlock();
+      return retval;
+    }
+
+    if (v->summary->size.load(std::memory_order_relaxed) == 0)
+      return retval;
+
+    Index index;
+    p->stolen.clear();
+    v->lock.lock();
+    for (auto ii = v->local.lower_bound(v->scanStart), ee = v->local.end(); ii != ee; ++ii) {
+      Bucket* b = ii->second;
+      if (!b->size)
+        continue;
+      unsigned int n = std::min(StealMax, (b->size + 1) / 2);
+      Galois::optional<T> r;
+      while (n-- && (r = popBucket(v, b)))
+        p->stolen.push_back(*r);
+      index = ii->first;
+      v->scanStart = index;
+      break;
+    }
+    if (p->stolen.empty())
+      v->scanStart = std::numeric_limits<Index>::max();
+    publish(v);
+    v->lock.unlock();
+
+    if (p->stolen.empty())
+      return retval;
+
+    retval = p->stolen.back();
+    p->stolen.pop_back();
+    if (!p->stolen.empty()) {
+      p->lock.lock();
+      Bucket* lC = updateLocalOrCreate(p, index);
+      for (auto& item : p->stolen)
+        lC->queue.push(item);
+      lC->size += p->stolen.size();
+      p->size += p->stolen.size();
+      if (index < p->scanStart)
+        p->scanStart = index;
+      if (index < p->curIndex) {
+        p->curIndex = index;
+        p->current = lC;
+      }
+      publish(p);
+      p->lock.unlock();
+    }
+    return retval;
+  }
+
+  inline Bucket* updateLocalOrCreate(perItem* p, Index i) {
     //Try local then try update then find again or else create and update the master log
     Timer tt(false);
-    CTy* lC;
+    Bucket* lC;
     tt.start();
     lC = p->local[i];
     *readLocalCyc += tt.stopwatch();
     if (lC)
       return lC;
-    lC = new (heap.allocate(sizeof(CTy))) CTy(i);
+    lC = new (heap.allocate(sizeof(Bucket))) Bucket(i);
     *createCtyCyc += tt.stopwatch();
 
     tt.start();
@@ -214,7 +324,9 @@ private:
   Statistic *updateLocalCyc, *readLocalCyc, *createCtyCyc;
 
 public:
-  dOrderedByIntegerMetric(const Indexer& x = Indexer()): heap(sizeof(CTy)), indexer(x), nQ(Galois::getActiveThreads()) {
+  dOrderedByIntegerMetric(const Indexer& x = Indexer()): heap(sizeof(Bucket)), indexer(x), nQ(Galois::getActiveThreads()) {
+    for (unsigned i = 0; i < Runtime::LL::getMaxThreads(); i++)
+      current.getRemote(i)->summary = summaryOf(i);
     updateLocalCyc = new Statistic("ObimUpdateLocalCyc");
     readLocalCyc = new Statistic("ObimReadLocalCyc");
     createCtyCyc = new Statistic("ObimCreateCtyCyc");
@@ -239,15 +351,18 @@ public:
     // Fast path
     p->lock.lock();
     if (index == p->curIndex && p->current) {
-      p->current->push(val);
+      p->current->queue.push(val);
+      ++p->current->size;
+      ++p->size;
       if (index < p->scanStart)
         p->scanStart = index;
+      publish(p);
       p->lock.unlock();
       return;
     }
 
     // Slow path
-    CTy* lC = updateLocalOrCreate(p, index);
+    Bucket* lC = updateLocalOrCreate(p, index);
     if (index < p->scanStart)
       p->scanStart = index;
     // Opportunistically move to higher priority work
@@ -255,7 +370,10 @@ public:
       p->curIndex = index;
       p->current = lC;
     }
-    lC->push(val);
+    lC->queue.push(val);
+    ++lC->size;
+    ++p->size;
+    publish(p);
     p->lock.unlock();
   }
 
@@ -276,20 +394,21 @@ public:
   Galois::optional<value_type> pop() {
     // Find a successful pop
     perItem* p = current.getLocal();
-    CTy* C = p->current;
+    Bucket* C = p->current;
 
     if (BlockPeriod && (BlockPeriod < 0 || (p->numPops++ & ((1ull<<BlockPeriod)-1) == 0)))
       return randomPop();
 
     p->lock.lock();
     Galois::optional<value_type> retval;
-    if (C && (retval = C->pop())) {
+    if (C && (retval = popBucket(p, C))) {
+      publish(p);
       p->lock.unlock();
       return retval;
     }
 
     // Slow path
-    retval = slowPop(p, true);
+    retval = slowPop(p);
     p->lock.unlock();
     if (retval)
       return retval;
@@ -43,6 +43,8 @@ private:
 
 public:
   typedef T value_type;
+  //! Polling a single global queue once it runs dry only burns cycles
+  typedef int tt_quiescence_termination;
 
   void push(const value_type& val) {
     pq.push(val);
@@ -24,20 +24,315 @@
 #define GALOIS_WORKLIST_OBIM_H
 
 #include "Galois/config.h"
-#include "Galois/FlatMap.h"
+#include "Galois/Statistic.h"
 #include "Galois/Timer.h"
 #include "Galois/Runtime/PerThreadStorage.h"
 #include "Galois/WorkList/Fifo.h"
 #include "Galois/WorkList/WorkListHelpers.h"
 
 #include GALOIS_CXX11_STD_HEADER(type_traits)
+#include <atomic>
+#include <cstdint>
+#include <deque>
 #include <limits>
+#include <vector>
 
 #include <iostream>
 
 namespace Galois {
 namespace WorkList {
 
+namespace detail {
+
+/**
+ * Concurrent map from priorities to buckets for OrderedByIntegerMetric: a
+ * 64-ary radix tree over the bits of the priority whose nodes are installed
+ * with CAS and never removed before destruction. Each node has a mask of
+ * its non-empty slots so that ordered searches skip empty ranges with bit
+ * scans. Lookups, insertions and searches are lock-free;
+ * removal of buckets must not run concurrently with another removal.
+ */
+template<typename CTy, typename Index>
+class BucketRegistry {
+public:
+  typedef typename std::make_unsigned<Index>::type Key;
+
+private:
+  static const unsigned KeyBits = std::numeric_limits<Key>::digits;
+  //! Including the leaves, which hold buckets
+  static const unsigned Levels = (KeyBits + 5) / 6;
+
+  struct Node {
+    std::atomic<uint64_t> present;
+    std::atomic<void*> slots[64];
+
+    Node(): present(0) {
+      for (int i = 0; i < 64; ++i)
+        slots[i].store(0, std::memory_order_relaxed);
+    }
+  };
+
+  Node root;
+
+  static unsigned slotOf(Key k, unsigned level) { return (k >> (6 * level)) & 63; }
+
+  Node* leafOf(Key k, bool create, Node** path = 0) {
+    Node* n = &root;
+    for (unsigned level = Levels - 1; level > 0; --level) {
+      if (path)
+        path[level] = n;
+      unsigned s = slotOf(k, level);
+      void* c = n->slots[s].load(std::memory_order_acquire);
+      if (!c) {
+        if (!create)
+          return 0;
+        Node* fresh = new Node();
+        if (n->slots[s].compare_exchange_strong(c, fresh)) {
+          n->present.fetch_or(1ull << s);
+          c = fresh;
+        } else {
+          delete fresh;
+        }
+      }
+      n = static_cast<Node*>(c);
+    }
+    return n;
+  }
+
+  static bool find(Node* n, unsigned level, Key base, Key start, Index& index, CTy*& bucket) {
+    unsigned first = base < start ? slotOf(start, level) : 0;
+    for (uint64_t m = n->present.load(std::memory_order_acquire) & (~0ull << first); m; m &= m - 1) {
+      unsigned s = __builtin_ctzll(m);
+      void* c = n->slots[s].load(std::memory_order_acquire);
+      if (!c)
+        continue;
+      Key k = base | (Key(s) << (6 * level));
+      if (level == 0) {
+        index = indexOf(k);
+        bucket = static_cast<CTy*>(c);
+        return true;
+      }
+      if (find(static_cast<Node*>(c), level - 1, k, start, index, bucket))
+        return true;
+    }
+    return false;
+  }
+
+  template<typename F>
+  static void remove(Node* n, unsigned level, Key base, Key from, Key to, F& f) {
+    unsigned shift = 6 * level;
+    for (uint64_t m = n->present.load(std::memory_order_acquire); m; m &= m - 1) {
+      unsigned s = __builtin_ctzll(m);
+      Key k = base | (Key(s) << shift);
+      if (k >= to)
+        break;
+      if ((k >> shift) < (from >> shift))
+        continue;
+      Node* child = 0;
+      if (level == 0) {
+        if (void* c = n->slots[s].exchange(0))
+          f(static_cast<CTy*>(c));
+      } else if ((child = static_cast<Node*>(n->slots[s].load(std::memory_order_acquire)))) {
+        remove(child, level - 1, k, from, to, f);
+        if (child->present.load())
+          continue;
+      } else {
+        continue;
+      }
+      // Clear the bit of the emptied slot, then restore it if an insertion
+      // raced with us; insert() sets bits after filling slots, so one of
+      // the two sides sees the other
+      n->present.fetch_and(~(1ull << s));
+      if (level == 0 ? n->slots[s].load() != 0 : child->present.load() != 0)
+        n->present.fetch_or(1ull << s);
+    }
+  }
+
+  static void destroy(Node* n, unsigned level) {
+    if (level > 0) {
+      for (int i = 0; i < 64; ++i)
+        if (void* c = n->slots[i].load(std::memory_order_relaxed)) {
+          destroy(static_cast<Node*>(c), level - 1);
+          delete static_cast<Node*>(c);
+        }
+    }
+  }
+
+public:
+  ~BucketRegistry() { destroy(&root, Levels - 1); }
+
+  //! Order-preserving map of priorities to keys
+  static Key keyOf(Index i) {
+    Key k = static_cast<Key>(i);
+    if (std::numeric_limits<Index>::is_signed)
+      k ^= Key(1) << (KeyBits - 1);
+    return k;
+  }
+
+  static Index indexOf(Key k) {
+    if (std::numeric_limits<Index>::is_signed)
+      k ^= Key(1) << (KeyBits - 1);
+    return static_cast<Index>(k);
+  }
+
+  CTy* get(Index i) {
+    Key k = keyOf(i);
+    Node* leaf = leafOf(k, false);
+    return leaf ? static_cast<CTy*>(leaf->slots[slotOf(k, 0)].load(std::memory_order_acquire)) : 0;
+  }
+
+  //! Registers fresh for i unless there is a bucket already; returns the
+  //! registered bucket
+  CTy* insert(Index i, CTy* fresh) {
+    Key k = keyOf(i);
+    Node* path[Levels];
+    Node* leaf = leafOf(k, true, path);
+    unsigned s = slotOf(k, 0);
+    void* c = 0;
+    if (!leaf->slots[s].compare_exchange_strong(c, fresh))
+      return static_cast<CTy*>(c);
+    leaf->present.fetch_or(1ull << s);
+    // Ancestors may have been marked empty by a removal
+    for (unsigned level = 1; level < Levels; ++level) {
+      uint64_t bit = 1ull << slotOf(k, level);
+      if (!(path[level]->present.load() & bit))
+        path[level]->present.fetch_or(bit);
+    }
+    return fresh;
+  }
+
+  //! Finds the registered bucket with the smallest key not less than start
+  bool next(Key start, Index& index, CTy*& bucket) {
+    return find(&root, Levels - 1, 0, start, index, bucket);
+  }
+
+  //! Unregisters the buckets with keys in [from, to) and calls f on each.
+  //! Ranges of the tree below from that were cleared before are skipped.
+  template<typename F>
+  void removeRange(Key from, Key to, F f) {
+    remove(&root, Levels - 1, 0, from, to, f);
+  }
+};
+
+/**
+ * Bucket of OrderedByIntegerMetric split into one sub-bucket per package.
+ * Threads push into the sub-bucket of their package and pop from it first;
+ * only when it is empty do they turn to the other packages, in package
+ * order starting after their own, and only to those marked occupied.
+ *
+ * A package is marked occupied by its pushes. A thread that finds a
+ * sub-bucket empty clears the mark and pops once more, restoring the mark
+ * if that succeeds, so a push racing with the clear is not hidden.
+ *
+ * Chunked containers hand out whole chunks, whose remaining items are then
+ * only visible to the popping thread, as are partially filled chunks to
+ * their pusher. Threads therefore always probe their own package and keep
+ * probing the remote package they last popped from until it runs dry,
+ * whatever its mark says.
+ */
+template<typename CTy>
+class PackageBuckets : private boost::noncopyable {
+  //! Packages beyond this are probed without consulting the marks
+  static const unsigned MarkBits = 64;
+
+  CTy* subs;
+  unsigned numSubs;
+  //! Per thread, one more than the remote package it last popped from
+  unsigned* lastRemote;
+  std::atomic<uint64_t> occupied;
+
+  static uint64_t markOf(unsigned pkg) {
+    return pkg < MarkBits ? (uint64_t) 1 << pkg : 0;
+  }
+
+  bool marked(unsigned pkg) const {
+    return pkg >= MarkBits || (occupied.load(std::memory_order_relaxed) & markOf(pkg));
+  }
+
+  Galois::optional<typename CTy::value_type> popFrom(unsigned pkg) {
+    Galois::optional<typename CTy::value_type> r = subs[pkg].pop();
+    if (r || pkg >= MarkBits)
+      return r;
+    if (occupied.load(std::memory_order_relaxed) & markOf(pkg)) {
+      occupied.fetch_and(~markOf(pkg));
+      if ((r = subs[pkg].pop()))
+        occupied.fetch_or(markOf(pkg));
+    }
+    return r;
+  }
+
+public:
+  typedef typename CTy::value_type value_type;
+
+  template<typename... Args>
+  explicit PackageBuckets(const Args&... args):
+    numSubs(Runtime::LL::getMaxPackages()),
+    lastRemote(new unsigned[Runtime::LL::getMaxThreads()]()),
+    occupied(0)
+  {
+    subs = static_cast<CTy*>(operator new(sizeof(CTy) * numSubs));
+    for (unsigned i = 0; i < numSubs; ++i)
+      new (&subs[i]) CTy(args...);
+  }
+
+  ~PackageBuckets() {
+    for (unsigned i = 0; i < numSubs; ++i)
+      subs[i].~CTy();
+    operator delete(subs);
+    delete [] lastRemote;
+  }
+
+  void push(const value_type& val) {
+    unsigned me = Runtime::LL::getPackageForSelf(Runtime::LL::getTID());
+    subs[me].push(val);
+    uint64_t m = markOf(me);
+    if (m && !(occupied.load(std::memory_order_relaxed) & m))
+      occupied.fetch_or(m);
+  }
+
+  unsigned peek(const value_type** out, unsigned max) {
+    unsigned me = Runtime::LL::getPackageForSelf(Runtime::LL::getTID());
+    return detail::peekNext(subs[me], out, max);
+  }
+
+  Galois::optional<value_type> pop() {
+    unsigned tid = Runtime::LL::getTID();
+    unsigned me = Runtime::LL::getPackageForSelf(tid);
+    Galois::optional<value_type> r;
+    if ((r = popFrom(me)))
+      return r;
+    if (unsigned last = lastRemote[tid]) {
+      if ((r = popFrom(last - 1)))
+        return r;
+      lastRemote[tid] = 0;
+    }
+    for (unsigned k = 1; k < numSubs; ++k) {
+      unsigned pkg = me + k < numSubs ? me + k : me + k - numSubs;
+      if (marked(pkg) && (r = popFrom(pkg))) {
+        lastRemote[tid] = pkg + 1;
+        return r;
+      }
+    }
+    return r;
+  }
+};
+
+} // end namespace detail
+
+/**
+ * Settings for OrderedByIntegerMetric with an adaptive delta. They are read
+ * when the worklist is constructed.
+ */
+struct OBIMDeltaConfig {
+  int initialShift; //!< buckets start out 2^initialShift priorities wide
+  int maxShift;
+
+  static OBIMDeltaConfig& get() {
+    static OBIMDeltaConfig config = { 0, 24 };
+    return config;
+  }
+};
+
 /**
  * Approximate priority scheduling. Indexer is a default-constructable class
  * whose instances conform to <code>R r = indexer(item)</code> where R is
@@ -56,11 +351,33 @@ namespace WorkList {
  * Galois::for_each<WL>(items.begin(), items.end(), Fn);
  * \endcode
  *
+ * With AdaptiveDelta, a bucket is keyed by the lowest priority it may
+ * hold, (index >> shift) << shift, so buckets of different widths coexist
+ * and old ones simply drain when shift changes. Every DeltaPeriod pops, a
+ * thread narrows the buckets if more than 1/8 of its pops were reported as
+ * wasted work and otherwise widens them if more than 1/16 of its pops found
+ * the current bucket empty.
+ *
+ * Buckets below the scanStart of every thread are retired: they are
+ * dropped from the per-thread maps and their containers are reused for new
+ * priorities once all threads have seen the retirement, so memory and the
+ * cost of scanning for work stay bounded by the active priority window.
+ *
+ * With NumaBuckets, each bucket holds one container per package. Threads
+ * push into their own package's container and, at a given priority, only
+ * take work from other packages once their own has run dry, before moving
+ * on to worse priorities.
+ *
  * @tparam Indexer Indexer class
  * @tparam Container Scheduler for each bucket
  * @tparam BlockPeriod Check for higher priority work every 2^BlockPeriod
  *                     iterations
  * @tparam BSP Use back-scan prevention
+ * @tparam AdaptiveDelta Group priorities into buckets of width 2^shift,
+ *                       adapting shift at runtime (see OBIMDeltaConfig)
+ * @tparam NumaBuckets Split each bucket into per-package sub-buckets and
+ *                     pop from remote packages only after the local one
+ *                     (see detail::PackageBuckets)
  */
 template<class Indexer = DummyIndexer<int>, typename Container = FIFO<>,
   int BlockPeriod=0,
@@ -68,84 +385,215 @@ template<class Indexer = DummyIndexer<int>, typename Container = FIFO<>,
   bool uniformBSP=false,
   typename T=int,
   typename Index=int,
-  bool Concurrent=true>
+  bool Concurrent=true,
+  bool AdaptiveDelta=false,
+  bool NumaBuckets=false>
 struct OrderedByIntegerMetric : private boost::noncopyable {
   template<bool _concurrent>
-  struct rethread { typedef OrderedByIntegerMetric<Indexer, typename Container::template rethread<_concurrent>::type, BlockPeriod, BSP, uniformBSP, T, Index, _concurrent> type; };
+  struct rethread { typedef OrderedByIntegerMetric<Indexer, typename Container::template rethread<_concurrent>::type, BlockPeriod, BSP, uniformBSP, T, Index, _concurrent, AdaptiveDelta, NumaBuckets> type; };
 
   template<typename _T>
-  struct retype { typedef OrderedByIntegerMetric<Indexer, typename Container::template retype<_T>::type, BlockPeriod, BSP, uniformBSP, _T, typename std::result_of<Indexer(_T)>::type, Concurrent> type; };
+  struct retype { typedef OrderedByIntegerMetric<Indexer, typename Container::template retype<_T>::type, BlockPeriod, BSP, uniformBSP, _T, typename std::result_of<Indexer(_T)>::type, Concurrent, AdaptiveDelta, NumaBuckets> type; };
 
   template<unsigned _period>
-  struct with_block_period { typedef OrderedByIntegerMetric<Indexer, Container, _period, BSP, uniformBSP, T, Index, Concurrent> type; };
+  struct with_block_period { typedef OrderedByIntegerMetric<Indexer, Container, _period, BSP, uniformBSP, T, Index, Concurrent, AdaptiveDelta, NumaBuckets> type; };
 
   template<typename _container>
-  struct with_container { typedef OrderedByIntegerMetric<Indexer, _container, BlockPeriod, BSP, uniformBSP, T, Index, Concurrent> type; };
+  struct with_container { typedef OrderedByIntegerMetric<Indexer, _container, BlockPeriod, BSP, uniformBSP, T, Index, Concurrent, AdaptiveDelta, NumaBuckets> type; };
 
   template<typename _indexer>
-  struct with_indexer { typedef OrderedByIntegerMetric<_indexer, Container, BlockPeriod, BSP, uniformBSP, T, Index, Concurrent> type; };
+  struct with_indexer { typedef OrderedByIntegerMetric<_indexer, Container, BlockPeriod, BSP, uniformBSP, T, Index, Concurrent, AdaptiveDelta, NumaBuckets> type; };
 
   template<bool _bsp>
-  struct with_back_scan_prevention { typedef OrderedByIntegerMetric<Indexer, Container, BlockPeriod, _bsp, uniformBSP, T, Index, Concurrent> type; };
+  struct with_back_scan_prevention { typedef OrderedByIntegerMetric<Indexer, Container, BlockPeriod, _bsp, uniformBSP, T, Index, Concurrent, AdaptiveDelta, NumaBuckets> type; };
+
+  template<bool _adaptive>
+  struct with_adaptive_delta { typedef OrderedByIntegerMetric<Indexer, Container, BlockPeriod, BSP, uniformBSP, T, Index, Concurrent, _adaptive, NumaBuckets> type; };
+
+  template<bool _numa>
+  struct with_numa_buckets { typedef OrderedByIntegerMetric<Indexer, Container, BlockPeriod, BSP, uniformBSP, T, Index, Concurrent, AdaptiveDelta, _numa> type; };
 
   typedef T value_type;
 
 private:
-  typedef typename Container::template rethread<Concurrent>::type CTy;
-  typedef Galois::flat_map<Index, CTy*> LMapTy;
-  //typedef std::map<Index, CTy*> LMapTy;
+  typedef typename Container::template rethread<Concurrent>::type BucketTy;
+  typedef typename std::conditional<NumaBuckets, detail::PackageBuckets<BucketTy>, BucketTy>::type CTy;
+  typedef detail::BucketRegistry<CTy, Index> Registry;
+  typedef typename Registry::Key Key;
+
+  //! Entries of the per-thread bucket cache
+  static const unsigned int CacheSize = 32;
+  //! Slow pops try to retire buckets once this many priorities lie between
+  //! the last retirement and their scanStart...
+  static const unsigned int RetireThreshold = 64;
+  //! ... but only every 2^RetirePeriod such pops
+  static const unsigned int RetirePeriod = 4;
+  //! Pops between adjustments of the delta by a thread
+  static const unsigned int DeltaPeriod = 256;
+
+  struct CacheEntry {
+    Index index;
+    CTy* bucket;
+  };
 
   struct perItem {
-    LMapTy local;
     Index curIndex;
     Index scanStart;
     CTy* current;
-    unsigned int lastMasterVersion;
+    //! Last retirement epoch this thread has caught up with
+    std::atomic<unsigned int> epoch;
     unsigned int numPops;
+    unsigned int numSlowPops;
+    //! Bucket that lost a creation race, used for the next creation
+    CTy* spare;
+    //! Items found in retired buckets
+    std::vector<T> spill;
+    unsigned int deltaPops;
+    unsigned int deltaMisses;
+    unsigned long deltaWasted;
+    //! Paces the samples of the bucket being drained
+    Galois::SamplePacer pacer;
+    CacheEntry cache[CacheSize];
 
     perItem() :
       curIndex(std::numeric_limits<Index>::min()), 
       scanStart(std::numeric_limits<Index>::min()),
-      current(0), lastMasterVersion(0), numPops(0) { }
-  };
+      current(0), epoch(0), numPops(0), numSlowPops(0), spare(0),
+      deltaPops(0), deltaMisses(0), deltaWasted(0), pacer(16)
+    {
+      clearCache();
+    }
+
+    void clearCache() {
+      for (unsigned i = 0; i < CacheSize; ++i)
+        cache[i].bucket = 0;
+    }
 
-  typedef std::deque<std::pair<Index, CTy*> > MasterLog;
+    CacheEntry& cacheFor(Index i) {
+      return cache[static_cast<Key>(i) % CacheSize];
+    }
+  };
 
-  // NB: Place dynamically growing masterLog after fixed-size PerThreadStorage
+  // NB: Place dynamically growing containers after fixed-size PerThreadStorage
   // members to give higher likelihood of reclaiming PerThreadStorage
   Runtime::PerThreadStorage<perItem> current;
-  Runtime::LL::PaddedLock<Concurrent> masterLock;
+  //! Priorities of the buckets threads move to when their bucket runs dry
+  Galois::Histogram bucketAtPop;
+  Runtime::LL::PaddedLock<Concurrent> retireLock;
   Galois::Timer clock;
-  MasterLog masterLog;
+  Registry registry;
+  //! Buckets retired in each epoch; guarded by retireLock
+  std::deque<std::pair<unsigned int, CTy*> > retired;
+  //! Buckets no thread refers to anymore; guarded by retireLock
+  std::vector<CTy*> freeBuckets;
+  //! Keys below this have been retired
+  std::atomic<Key> retiredBelow;
 
   Runtime::MM::FixedSizeAllocator heap;
-  std::atomic<unsigned int> masterVersion;
+  std::atomic<unsigned int> epoch;
+  std::atomic<int> deltaShift;
+  int maxDeltaShift;
   Indexer indexer;
 
-  bool updateLocal(perItem& p) {
-    if (p.lastMasterVersion != masterVersion.load(std::memory_order_relaxed)) {
-      //masterLock.lock();
-      for (; p.lastMasterVersion < masterVersion.load(std::memory_order_relaxed); ++p.lastMasterVersion) {
-        // XXX(ddn): Somehow the second block is better than
-        // the first for bipartite matching (GCC 4.7.2)
-#if 0
-        p.local.insert(masterLog[p.lastMasterVersion]);
-#else
-        std::pair<Index, CTy*> logEntry = masterLog[p.lastMasterVersion];
-        p.local[logEntry.first] = logEntry.second;
-        assert(logEntry.second);
-#endif
-      }
-      //masterLock.unlock();
-      return true;
+  Index bucketOf(const value_type& val) {
+    Index index = indexer(val);
+    if (AdaptiveDelta) {
+      int shift = deltaShift.load(std::memory_order_relaxed);
+      index = (index >> shift) << shift;
     }
-    return false;
+    return index;
+  }
+
+  GALOIS_ATTRIBUTE_NOINLINE
+  void adaptDelta(perItem& p) {
+    unsigned long wasted = *OBIMDeltaFeedback::counters().getLocal();
+    unsigned long windowWasted = wasted - p.deltaWasted;
+    int shift = deltaShift.load(std::memory_order_relaxed);
+    if (windowWasted * 8 > p.deltaPops) {
+      if (shift > 0)
+        deltaShift.compare_exchange_strong(shift, shift - 1, std::memory_order_relaxed);
+    } else if (p.deltaMisses * 16 > p.deltaPops) {
+      if (shift < maxDeltaShift)
+        deltaShift.compare_exchange_strong(shift, shift + 1, std::memory_order_relaxed);
+    }
+    p.deltaWasted = wasted;
+    p.deltaPops = p.deltaMisses = 0;
+  }
+
+  /**
+   * Catch up with retirements. Whatever this thread pushed into a retired
+   * bucket since (through its cache or current bucket) is only visible to
+   * it, e.g., a partially filled chunk, so it is moved to the spill list.
+   */
+  GALOIS_ATTRIBUTE_NOINLINE
+  void slowCatchUp(perItem& p) {
+    retireLock.lock();
+    unsigned int e = epoch.load(std::memory_order_relaxed);
+    unsigned int mine = p.epoch.load(std::memory_order_relaxed);
+    for (auto ii = retired.rbegin(), ei = retired.rend(); ii != ei && ii->first > mine; ++ii) {
+      Galois::optional<T> r;
+      while ((r = ii->second->pop()))
+        p.spill.push_back(*r);
+    }
+    p.clearCache();
+    p.current = 0;
+    p.epoch.store(e, std::memory_order_release);
+    retireLock.unlock();
+  }
+
+  inline void catchUp(perItem& p) {
+    if (p.epoch.load(std::memory_order_relaxed) != epoch.load(std::memory_order_acquire))
+      slowCatchUp(p);
+  }
+
+  //! Retire buckets below every thread's scanStart and recycle buckets
+  //! that all threads have seen retired; requires retireLock
+  void retireBuckets() {
+    Index bound = std::numeric_limits<Index>::max();
+    for (unsigned i = 0; i < Runtime::activeThreads; ++i)
+      bound = std::min(bound, current.getRemote(i)->scanStart);
+
+    Key from = retiredBelow.load(std::memory_order_relaxed);
+    Key to = Registry::keyOf(bound);
+    if (from < to) {
+      unsigned int e = epoch.load(std::memory_order_relaxed) + 1;
+      bool any = false;
+      registry.removeRange(from, to, [&](CTy* lC) {
+        retired.push_back(std::make_pair(e, lC));
+        any = true;
+      });
+      retiredBelow.store(to, std::memory_order_relaxed);
+      if (any)
+        epoch.store(e, std::memory_order_release);
+    }
+
+    unsigned int horizon = epoch.load(std::memory_order_relaxed);
+    for (unsigned i = 0; i < Runtime::activeThreads; ++i)
+      horizon = std::min(horizon, current.getRemote(i)->epoch.load(std::memory_order_acquire));
+    for (; !retired.empty() && retired.front().first <= horizon; retired.pop_front())
+      freeBuckets.push_back(retired.front().second);
   }
 
   GALOIS_ATTRIBUTE_NOINLINE
   Galois::optional<T> slowPop(perItem& p) {
     //Failed, find minimum bin
-    updateLocal(p);
+    catchUp(p);
+    if (!p.spill.empty()) {
+      Galois::optional<T> retval(p.spill.back());
+      p.spill.pop_back();
+      return retval;
+    }
+
+    Key scanKey = Registry::keyOf(p.scanStart);
+    Key retiredKey = retiredBelow.load(std::memory_order_relaxed);
+    if (scanKey > retiredKey && scanKey - retiredKey >= RetireThreshold
+        && (++p.numSlowPops & ((1u << RetirePeriod) - 1)) == 0
+        && retireLock.try_lock()) {
+      retireBuckets();
+      retireLock.unlock();
+      catchUp(p);
+    }
+
     unsigned myID = Runtime::LL::getTID();
     bool localLeader = Runtime::LL::isPackageLeaderForSelf(myID);
 
@@ -160,68 +608,99 @@ private:
       }
     }
 
-    for (auto ii = p.local.lower_bound(msS), ee = p.local.end(); ii != ee; ++ii) {
+    Index index;
+    CTy* lC;
+    for (Key k = Registry::keyOf(msS); registry.next(k, index, lC); k = Registry::keyOf(index) + 1) {
       Galois::optional<T> retval;
-      if ((retval = ii->second->pop())) {
-        p.current = ii->second;
-        p.curIndex = ii->first;
-        p.scanStart = ii->first;
+      if ((retval = lC->pop())) {
+        p.current = lC;
+        p.curIndex = index;
+        p.scanStart = index;
+        // Negative priorities count as 0
+        unsigned long prio = index > Index() ? static_cast<unsigned long>(index) : 0;
+        bucketAtPop.add(prio);
+        if (p.pacer.due())
+          Runtime::reportSample(0, "OBIMBucket", prio);
         return retval;
       }
+      if (index == std::numeric_limits<Index>::max())
+        break;
     }
     return Galois::optional<value_type>();
   }
 
   GALOIS_ATTRIBUTE_NOINLINE
   CTy* slowUpdateLocalOrCreate(perItem& p, Index i) {
-    //update local until we find it or we get the write lock
-    do {
-      CTy* lC;
-      updateLocal(p);
-      if ((lC = p.local[i]))
-        return lC;
-    } while (!masterLock.try_lock());
-    //we have the write lock, update again then create
-    updateLocal(p);
-    CTy*& lC2 = p.local[i];
-    if (!lC2) {
-      lC2 = new (heap.allocate(sizeof(CTy))) CTy(i);
-      p.lastMasterVersion = masterVersion.load(std::memory_order_relaxed) + 1;
-      masterLog.push_back(std::make_pair(i, lC2));
-      masterVersion.fetch_add(1);
+    catchUp(p);
+    CTy* lC = registry.get(i);
+    if (!lC) {
+      CTy* fresh = p.spare;
+      p.spare = 0;
+      if (!fresh && retireLock.try_lock()) {
+        if (!freeBuckets.empty()) {
+          fresh = freeBuckets.back();
+          freeBuckets.pop_back();
+        }
+        retireLock.unlock();
+      }
+      if (!fresh)
+        fresh = new (heap.allocate(sizeof(CTy))) CTy(i);
+      if ((lC = registry.insert(i, fresh)) != fresh)
+        p.spare = fresh;
     }
-    masterLock.unlock();
-    return lC2;
+    CacheEntry& c = p.cacheFor(i);
+    c.index = i;
+    c.bucket = lC;
+    return lC;
   }
 
   inline CTy* updateLocalOrCreate(perItem& p, Index i) {
-    //Try local then try update then find again or else create and update the master log
-    CTy* lC;
-    if ((lC = p.local[i]))
-      return lC;
+    //Try the cache, then the registry, or else create
+    CacheEntry& c = p.cacheFor(i);
+    if (c.bucket && c.index == i)
+      return c.bucket;
     //slowpath
     return slowUpdateLocalOrCreate(p, i);
   }
 
+  void deallocate(CTy* lC) {
+    lC->~CTy();
+    heap.deallocate(lC);
+  }
+
 public:
-  OrderedByIntegerMetric(const Indexer& x = Indexer()): heap(sizeof(CTy)), masterVersion(0), indexer(x) {
+  OrderedByIntegerMetric(const Indexer& x = Indexer()):
+    bucketAtPop("OBIMBucketAtPop"), retiredBelow(0), heap(sizeof(CTy)), epoch(0),
+    deltaShift(OBIMDeltaConfig::get().initialShift),
+    maxDeltaShift(OBIMDeltaConfig::get().maxShift),
+    indexer(x)
+  {
+    if (AdaptiveDelta) {
+      // Start counting from the current totals
+      for (unsigned i = 0; i < Runtime::LL::getMaxThreads(); ++i)
+        current.getRemote(i)->deltaWasted = *OBIMDeltaFeedback::counters().getRemote(i);
+    }
     clock.start();
   }
 
   ~OrderedByIntegerMetric() {
-    perItem& p = *current.getLocal();
-    updateLocal(p);
-    // Deallocate in LIFO order to give opportunity for simple garbage
-    // collection
-    for (auto ii = masterLog.rbegin(), ei = masterLog.rend(); ii != ei; ++ii) {
-      CTy* lC = ii->second;
-      lC->~CTy();
-      heap.deallocate(lC);
-    }
+    if (AdaptiveDelta)
+      Runtime::reportStat(0, "OBIMDeltaShift", deltaShift.load(std::memory_order_relaxed));
+    registry.removeRange(0, std::numeric_limits<Key>::max(), [&](CTy* lC) { deallocate(lC); });
+    // removeRange excludes its upper bound
+    if (CTy* lC = registry.get(Registry::indexOf(std::numeric_limits<Key>::max())))
+      deallocate(lC);
+    for (auto& e : retired)
+      deallocate(e.second);
+    for (CTy* lC : freeBuckets)
+      deallocate(lC);
+    for (unsigned i = 0; i < Runtime::LL::getMaxThreads(); ++i)
+      if (CTy* lC = current.getRemote(i)->spare)
+        deallocate(lC);
   }
 
   void push(const value_type& val) {
-    Index index = indexer(val);
+    Index index = bucketOf(val);
     perItem& p = *current.getLocal();
     // Fast path
     if (index == p.curIndex && p.current) {
@@ -231,7 +710,8 @@ public:
 
     // Slow path
     CTy* lC = updateLocalOrCreate(p, index);
-    if (BSP && index < p.scanStart)
+    // scanStart also bounds bucket retirement, so maintain it even without BSP
+    if (index < p.scanStart)
       p.scanStart = index;
     // Opportunistically move to higher priority work
     if (index < p.curIndex) {
@@ -255,10 +735,33 @@ public:
     return push(rp.first, rp.second);
   }
 
+  /**
+   * Pop up to max items into uninitialized storage at out and return their
+   * number. Items after the first come from the same bucket.
+   */
+  unsigned peek(const value_type** out, unsigned max) {
+    CTy* C = current.getLocal()->current;
+    return C ? detail::peekNext(*C, out, max) : 0;
+  }
+
+  unsigned pop_batch(value_type* out, unsigned max) {
+    Galois::optional<value_type> retval = pop();
+    if (!retval)
+      return 0;
+    new (out) value_type(*retval);
+    CTy* C = current.getLocal()->current;
+    unsigned num = 1;
+    while (num < max && C && (retval = C->pop()))
+      new (&out[num++]) value_type(*retval);
+    return num;
+  }
+
   Galois::optional<value_type> pop() {
     // Find a successful pop
     perItem& p = *current.getLocal();
     CTy* C = p.current;
+    if (AdaptiveDelta && ++p.deltaPops == DeltaPeriod)
+      adaptDelta(p);
     if (BlockPeriod && (BlockPeriod < 0 || (p.numPops++ & ((1ull<<BlockPeriod)-1) == 0)))
       return slowPop(p);
 
@@ -268,6 +771,8 @@ public:
     }
 
     // Slow path
+    if (AdaptiveDelta)
+      ++p.deltaMisses;
     return slowPop(p);
   }
 };
@@ -0,0 +1,291 @@
+/** Named priority schedulers -*- C++ -*-
+ * @file
+ * @section License
+ *
+ * Galois, a framework to exploit amorphous data-parallelism in irregular
+ * programs.
+ *
+ * Copyright (C) 2013, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ *
+ * @section Description
+ *
+ * Builds the priority worklists selected by the -wl option of the ordered
+ * applications from a single table, so that every application accepts the
+ * same scheduler names.
+ */
+#ifndef GALOIS_WORKLIST_SCHEDULERREGISTRY_H
+#define GALOIS_WORKLIST_SCHEDULERREGISTRY_H
+
+#include "Galois/WorkList/WorkList.h"
+
+#include <ostream>
+#include <string>
+#include <type_traits>
+
+namespace Galois {
+namespace WorkList {
+
+/**
+ * Describes the priorities of an application to {@link SchedulerRegistry}.
+ * Applications whose k-LSM keys differ from their bucket indices derive from
+ * this and redefine lsm_indexer and lsm_node_indexer.
+ *
+ * @tparam T work item
+ * @tparam Indexer maps items to buckets for the OBIM family
+ * @tparam Comparer priority order of the concurrent priority queues
+ * @tparam NodeComparer like Comparer but breaks ties by node (-nc variants)
+ * @tparam Hasher partitions items for ppq; void leaves ppq unavailable
+ * @tparam ChunkSize chunk size of the bucket containers
+ * @tparam BlockPeriod block period of the OBIM family
+ */
+template<typename T, typename Indexer, typename Comparer, typename NodeComparer = Comparer,
+  typename Hasher = void, int ChunkSize = 64, int BlockPeriod = 0>
+struct SchedulerTraits {
+  typedef T value_type;
+  typedef Indexer indexer;
+  typedef Comparer comparer;
+  typedef NodeComparer node_comparer;
+  typedef Hasher hasher;
+  typedef Indexer lsm_indexer;
+  typedef Indexer lsm_node_indexer;
+  static const int chunk_size = ChunkSize;
+  static const int block_period = BlockPeriod;
+};
+
+/**
+ * The scheduler selected by {@link SchedulerRegistry::run}. Breaks is set
+ * for the concurrent priority queues with which applications use the
+ * parallel-break variant of their operator, if they have one.
+ */
+template<typename WL, bool Breaks>
+struct Scheduler {
+  typedef WL type;
+  static const bool breaks = Breaks;
+};
+
+/**
+ * Maps scheduler names to worklists for the priorities described by Traits.
+ * {@link run} calls fn(Scheduler<WL, Breaks>()) with the worklist of the
+ * given name, so an application only writes the loop itself once:
+ *
+ * \code
+ * struct Run {
+ *   template<typename S> void operator()(S) {
+ *     Galois::for_each_local(initial, Process(), Galois::wl<typename S::type>());
+ *   }
+ * };
+ * Run r;
+ * if (!SchedulerRegistry<Traits>::run(worklistname, r))
+ *   SchedulerRegistry<Traits>::printNames(std::cerr << "No work list! Choose one of:");
+ * \endcode
+ *
+ * klsm256 and klsm4096 set the relaxation in {@link kLSMConfig} before
+ * running the k-LSM; klsm uses whatever relaxation is configured there.
+ */
+template<typename Traits>
+class SchedulerRegistry {
+  typedef typename Traits::value_type T;
+  typedef typename Traits::indexer Indexer;
+  typedef typename Traits::comparer Comparer;
+  typedef typename Traits::node_comparer NodeComparer;
+  typedef typename Traits::hasher Hasher;
+  static const int CS = Traits::chunk_size;
+  static const int BP = Traits::block_period;
+
+  //! Placeholder for worklists the traits cannot build
+  struct Unavailable { };
+
+public:
+  typedef dChunkedFIFO<CS> Chunk;
+  typedef dVisChunkedFIFO<CS> VisChunk;
+  typedef dChunkedPTFIFO<1> NoChunk;
+  typedef ChunkedFIFO<CS> GlobChunk;
+  typedef ChunkedFIFO<1> GlobNoChunk;
+  typedef typename Chunk::template with_chunk_queue<ConExtRingQueue>::type RingChunk;
+  typedef typename VisChunk::template with_chunk_queue<ConExtRingQueue>::type RingVisChunk;
+
+  typedef OrderedByIntegerMetric<Indexer, Chunk, BP> OBIM;
+  typedef OrderedByIntegerMetric<Indexer, dChunkedLIFO<CS>, BP> OBIM_LIFO;
+  typedef OrderedByIntegerMetric<Indexer, Chunk, 4> OBIM_BLK4;
+  typedef OrderedByIntegerMetric<Indexer, Chunk, BP, false> OBIM_NOBSP;
+  typedef OrderedByIntegerMetric<Indexer, NoChunk, BP> OBIM_NOCHUNK;
+  typedef OrderedByIntegerMetric<Indexer, GlobChunk, BP> OBIM_GLOB;
+  typedef OrderedByIntegerMetric<Indexer, GlobNoChunk, BP> OBIM_GLOB_NOCHUNK;
+  typedef typename OBIM_GLOB::template with_numa_buckets<true>::type OBIM_NUMA;
+  typedef OrderedByIntegerMetric<Indexer, NoChunk, -1, false> OBIM_STRICT;
+  typedef OrderedByIntegerMetric<Indexer, Chunk, BP, true, true> OBIM_UBSP;
+  typedef OrderedByIntegerMetric<Indexer, VisChunk, BP, true, true> OBIM_VISCHUNK;
+  typedef OrderedByIntegerMetric<Indexer, RingChunk, BP> OBIM_RING;
+  typedef OrderedByIntegerMetric<Indexer, dAdaptiveChunkedFIFO<CS>, BP> OBIM_DYNCHUNK;
+  typedef OrderedByIntegerMetric<Indexer, RingVisChunk, BP, true, true> OBIM_VISCHUNK_RING;
+  typedef typename OBIM::template with_adaptive_delta<true>::type OBIM_ADAPT;
+  typedef SkipListOrderedByIntegerMetric<Indexer, Chunk, BP> SLOBIM;
+  typedef SkipListOrderedByIntegerMetric<Indexer, NoChunk, BP> SLOBIM_NOCHUNK;
+  typedef SkipListOrderedByIntegerMetric<Indexer, GlobNoChunk, BP> SLOBIM_GLOB_NOCHUNK;
+  typedef SkipListOrderedByIntegerMetric<Indexer, VisChunk, BP> SLOBIM_VISCHUNK;
+  typedef VectorOrderedByIntegerMetric<Indexer, Chunk, BP> VECOBIM;
+  typedef VectorOrderedByIntegerMetric<Indexer, NoChunk, BP> VECOBIM_NOCHUNK;
+  typedef VectorOrderedByIntegerMetric<Indexer, GlobNoChunk, BP> VECOBIM_GLOB_NOCHUNK;
+  typedef dOrderedByIntegerMetric<Indexer, GlobChunk, BP> DOBIM;
+  typedef dSkipListOrderedByIntegerMetric<Indexer, GlobChunk, BP> SLDOBIM;
+  typedef mqSkipListOrderedByIntegerMetric<Indexer, GlobChunk, BP> MQ4_SLDOBIM;
+  typedef swarmSkipListOrderedByIntegerMetric<Indexer, GlobChunk, BP> SWARM_SLDOBIM;
+
+  typedef GlobPQ<T, LockFreeSkipList<Comparer, T>> GPQ;
+  typedef GlobPQ<T, LockFreeSkipList<NodeComparer, T>> GPQ_NC;
+  typedef GlobPQ<T, KiWiPQ<Comparer, GaloisAllocator, T>> KIWIPQ;
+  typedef GlobPQ<T, SprayList<NodeComparer, T>> SL;
+  typedef GlobPQ<T, MultiQueue<Comparer, T, 1>> MQ1;
+  typedef GlobPQ<T, MultiQueue<Comparer, T, 4>> MQ4;
+  typedef GlobPQ<T, MultiQueue<NodeComparer, T, 4>> MQ4_NC;
+  typedef GlobPQ<T, HeapMultiQueue<Comparer, T, 1>> HMQ1;
+  typedef GlobPQ<T, HeapMultiQueue<Comparer, T, 4>> HMQ4;
+  typedef GlobPQ<T, HeapMultiQueue<NodeComparer, T, 4>> HMQ4_NC;
+  typedef GlobPQ<T, DistQueue<Comparer, T, false>> PTSL;
+  typedef GlobPQ<T, DistQueue<Comparer, T, true>> PPSL;
+  typedef GlobPQ<T, LocalPQ<Comparer, T, false>> LPQ;
+  typedef GlobPQ<T, LocalPQ<Comparer, T, true>> LPQPS;
+  typedef GlobPQ<T, SwarmPQ<Comparer, T>> SWARMPQ;
+  typedef GlobPQ<T, SwarmPQ<NodeComparer, T>> SWARMPQ_NC;
+  typedef GlobPQ<T, HeapSwarmPQ<Comparer, T>> HSWARMPQ;
+  typedef GlobPQ<T, HeapSwarmPQ<NodeComparer, T>> HSWARMPQ_NC;
+  typedef typename std::conditional<std::is_void<Hasher>::value,
+    Unavailable, GlobPQ<T, PartitionPQ<Comparer, Hasher, T>>>::type PPQ;
+  typedef GlobPQ<T, kLSMQ<T, typename Traits::lsm_indexer, 65536>> KLSM;
+  typedef GlobPQ<T, kLSMQ<T, typename Traits::lsm_node_indexer, 65536>> KLSM_NC;
+
+  typedef OrderedByIntegerMetric<Indexer, GPQ, BP> OBIM_BAG_SL;
+  typedef OrderedByIntegerMetric<Indexer, GPQ_NC, BP> OBIM_BAG_SL_NODECMP;
+  typedef OrderedByIntegerMetric<Indexer, HMQ4, BP> OBIM_BAG_HMQ4;
+
+private:
+  template<typename Fn>
+  struct Dispatch {
+    const std::string& name;
+    Fn& fn;
+    Dispatch(const std::string& n, Fn& f): name(n), fn(f) { }
+
+    template<typename WL, bool Breaks>
+    bool visit(const char* n, std::false_type) {
+      if (name != n)
+        return false;
+      fn(Scheduler<WL, Breaks>());
+      return true;
+    }
+
+    template<typename WL, bool Breaks>
+    bool visit(const char*, std::true_type) { return false; }
+  };
+
+  struct Print {
+    std::ostream& os;
+    Print(std::ostream& o): os(o) { }
+
+    template<typename WL, bool Breaks, typename Skip>
+    bool visit(const char* n, Skip) {
+      if (!Skip::value)
+        os << " " << n;
+      return false;
+    }
+  };
+
+  //! Visits every scheduler until v.visit returns true
+  template<typename V>
+  static bool visitAll(V& v) {
+    typedef std::false_type Y;
+    typedef std::integral_constant<bool, std::is_same<PPQ, Unavailable>::value> PPQSkip;
+    return
+      v.template visit<OBIM, false>("obim", Y())
+      || v.template visit<OBIM_STRICT, false>("obim-strict", Y())
+      || v.template visit<OBIM_UBSP, false>("obim-ubsp", Y())
+      || v.template visit<OBIM_LIFO, false>("obim-lifo", Y())
+      || v.template visit<OBIM_BLK4, false>("obim-blk4", Y())
+      || v.template visit<OBIM_NOBSP, false>("obim-nobsp", Y())
+      || v.template visit<OBIM_NOCHUNK, false>("obim-nochunk", Y())
+      || v.template visit<OBIM_ADAPT, false>("obim-adapt", Y())
+      || v.template visit<OBIM_VISCHUNK, false>("obim-vischunk", Y())
+      || v.template visit<OBIM_RING, false>("obim-ring", Y())
+      || v.template visit<OBIM_VISCHUNK_RING, false>("obim-vischunk-ring", Y())
+      || v.template visit<OBIM_DYNCHUNK, false>("obim-dynchunk", Y())
+      || v.template visit<OBIM_GLOB, false>("obim-glob", Y())
+      || v.template visit<OBIM_GLOB_NOCHUNK, false>("obim-glob-nochunk", Y())
+      || v.template visit<OBIM_NUMA, false>("obim-numa", Y())
+      || v.template visit<OBIM_BAG_SL, false>("obim-bag-sl", Y())
+      || v.template visit<OBIM_BAG_SL_NODECMP, false>("obim-bag-sl-nodecmp", Y())
+      || v.template visit<OBIM_BAG_HMQ4, false>("obim-bag-multiqueue4", Y())
+      || v.template visit<SLOBIM, false>("slobim", Y())
+      || v.template visit<SLOBIM_NOCHUNK, false>("slobim-nochunk", Y())
+      || v.template visit<SLOBIM_GLOB_NOCHUNK, false>("slobim-glob-nochunk", Y())
+      || v.template visit<SLOBIM_VISCHUNK, false>("slobim-vischunk", Y())
+      || v.template visit<VECOBIM, false>("vecobim", Y())
+      || v.template visit<VECOBIM_NOCHUNK, false>("vecobim-nochunk", Y())
+      || v.template visit<VECOBIM_GLOB_NOCHUNK, false>("vecobim-glob-nochunk", Y())
+      || v.template visit<DOBIM, false>("dobim", Y())
+      || v.template visit<SLDOBIM, false>("sldobim", Y())
+      || v.template visit<MQ4_SLDOBIM, false>("mq4-sldobim", Y())
+      || v.template visit<SWARM_SLDOBIM, false>("swarm-sldobim", Y())
+      || v.template visit<GPQ, true>("skiplist", Y())
+      || v.template visit<GPQ_NC, true>("skiplist-nc", Y())
+      || v.template visit<KIWIPQ, false>("kiwi-pq", Y())
+      || v.template visit<SL, true>("spraylist", Y())
+      || v.template visit<MQ1, true>("multiqueue1", Y())
+      || v.template visit<MQ4, true>("multiqueue4", Y())
+      || v.template visit<MQ4_NC, true>("multiqueue4-nc", Y())
+      || v.template visit<HMQ1, true>("heapmultiqueue1", Y())
+      || v.template visit<HMQ4, true>("heapmultiqueue4", Y())
+      || v.template visit<HMQ4_NC, true>("heapmultiqueue4-nc", Y())
+      || v.template visit<PTSL, true>("thrskiplist", Y())
+      || v.template visit<PPSL, true>("pkgskiplist", Y())
+      || v.template visit<LPQ, true>("lpq", Y())
+      || v.template visit<LPQPS, true>("lpqps", Y())
+      || v.template visit<SWARMPQ, true>("swarm", Y())
+      || v.template visit<SWARMPQ_NC, true>("swarm-nc", Y())
+      || v.template visit<HSWARMPQ, true>("heapswarm", Y())
+      || v.template visit<HSWARMPQ_NC, true>("heapswarm-nc", Y())
+      || v.template visit<PPQ, true>("ppq", PPQSkip())
+      || v.template visit<KLSM, false>("klsm", Y())
+      || v.template visit<KLSM, false>("klsm256", Y())
+      || v.template visit<KLSM, false>("klsm4096", Y())
+      || v.template visit<KLSM_NC, false>("klsm-nc", Y())
+      || v.template visit<KLSM_NC, false>("klsm256-nc", Y())
+      || v.template visit<KLSM_NC, false>("klsm4096-nc", Y());
+  }
+
+public:
+  /**
+   * Calls fn(Scheduler<WL, Breaks>()) with the worklist named name. Returns
+   * false if there is no such worklist.
+   */
+  template<typename Fn>
+  static bool run(const std::string& name, Fn& fn) {
+    if (name.compare(0, 7, "klsm256") == 0)
+      kLSMConfig::get().relaxation = 256;
+    else if (name.compare(0, 8, "klsm4096") == 0)
+      kLSMConfig::get().relaxation = 4096;
+    Dispatch<Fn> d(name, fn);
+    return visitAll(d);
+  }
+
+  //! Writes the names accepted by run, each preceded by a space
+  static std::ostream& printNames(std::ostream& os) {
+    Print p(os);
+    visitAll(p);
+    return os;
+  }
+};
+
+}
+} // end namespace Galois
+
+#endif
@@ -56,6 +56,12 @@ namespace WorkList {
  * Galois::for_each<WL>(items.begin(), items.end(), Fn);
  * \endcode
  *
+ * Pushes look up their bucket in a small per-thread direct-mapped cache
+ * before searching the shared skiplist. Buckets stay in the skiplist until
+ * the worklist is destroyed, so cached pointers remain valid; anything
+ * that unlinks buckets must bump masterVersion, which makes every thread
+ * flush its cache on its next lookup.
+ *
  * @tparam Indexer Indexer class
  * @tparam Container Scheduler for each bucket
  * @tparam BlockPeriod Check for higher priority work every 2^BlockPeriod
@@ -95,6 +101,14 @@ private:
   typedef Galois::flat_map<Index, CTy*> LMapTy;
   //typedef std::map<Index, CTy*> LMapTy;
 
+  //! Entries in the per-thread direct-mapped bucket cache
+  static const unsigned CacheSize = 32;
+
+  struct CacheEntry {
+    Index index;
+    CTy* bucket;
+  };
+
   struct perItem {
     LMapTy local;
     Index curIndex;
@@ -102,11 +116,23 @@ private:
     CTy* current;
     unsigned int lastMasterVersion;
     unsigned int numPops;
+    CacheEntry cache[CacheSize];
 
     perItem() :
       curIndex(std::numeric_limits<Index>::min()), 
       scanStart(std::numeric_limits<Index>::min()),
-      current(0), lastMasterVersion(0), numPops(0) { }
+      current(0), lastMasterVersion(0), numPops(0) {
+      clearCache();
+    }
+
+    void clearCache() {
+      for (unsigned i = 0; i < CacheSize; ++i)
+        cache[i].bucket = 0;
+    }
+
+    CacheEntry& slot(Index i) {
+      return cache[static_cast<size_t>(i) & (CacheSize - 1)];
+    }
   };
 
   typedef std::deque<std::pair<Index, CTy*> > MasterLog;
@@ -166,17 +192,32 @@ private:
 
   GALOIS_ATTRIBUTE_NOINLINE
   CTy* slowUpdateLocalOrCreate(perItem& p, Index i) {
-    CTy* lC = new (heap.allocate(sizeof(CTy))) CTy(i);
-    if (Q.push(i, lC))
-      return lC;
-    return Q.get(i);
+    CTy* lC;
+    if (!(lC = Q.get(i))) {
+      lC = new (heap.allocate(sizeof(CTy))) CTy(i);
+      if (!Q.push(i, lC)) {
+        // Lost the race to create the bucket
+        lC->~CTy();
+        heap.deallocate(lC);
+        lC = Q.get(i);
+      }
+    }
+    CacheEntry& e = p.slot(i);
+    e.index = i;
+    e.bucket = lC;
+    return lC;
   }
 
   inline CTy* updateLocalOrCreate(perItem& p, Index i) {
-    //Try local then try update then find again or else create and update the master log
-    CTy* lC;
-    if ((lC = Q.get(i)))
-      return lC;
+    //Try the local cache, then the skiplist, or else create the bucket
+    unsigned int mv = masterVersion.load(std::memory_order_acquire);
+    if (p.lastMasterVersion != mv) {
+      p.clearCache();
+      p.lastMasterVersion = mv;
+    }
+    CacheEntry& e = p.slot(i);
+    if (e.bucket && e.index == i)
+      return e.bucket;
     //slowpath
     return slowUpdateLocalOrCreate(p, i);
   }
@@ -31,6 +31,8 @@
 #include "Galois/WorkList/WorkListHelpers.h"
 
 #include GALOIS_CXX11_STD_HEADER(type_traits)
+#include <atomic>
+#include <cstdint>
 #include <limits>
 
 #include <iostream>
@@ -38,6 +40,231 @@
 namespace Galois {
 namespace WorkList {
 
+//! Implementation details for VectorOrderedByIntegerMetric
+namespace detail {
+
+/**
+ * Array of bucket pointers indexed by priority that grows on demand.
+ * Segment s holds 2^(FirstSegmentBits + s) buckets, so a priority is mapped
+ * to its slot with a single bit scan and segments never move once installed.
+ */
+template<typename CTy, unsigned IndexBits>
+class BucketVector {
+  static const unsigned FirstSegmentBits = 10;
+  static const unsigned NumSegments = IndexBits - FirstSegmentBits + 1;
+
+  std::atomic<std::atomic<CTy*>*> segments[NumSegments];
+
+  std::atomic<CTy*>* segment(unsigned s, bool create) {
+    std::atomic<CTy*>* seg = segments[s].load(std::memory_order_acquire);
+    if (seg || !create)
+      return seg;
+    size_t size = 1ull << (FirstSegmentBits + s);
+    std::atomic<CTy*>* fresh = new std::atomic<CTy*>[size];
+    for (size_t i = 0; i < size; ++i)
+      fresh[i].store(0, std::memory_order_relaxed);
+    if (segments[s].compare_exchange_strong(seg, fresh))
+      return fresh;
+    delete [] fresh;
+    return seg;
+  }
+
+  std::atomic<CTy*>* slot(uint64_t i, bool create) {
+    uint64_t ip = i + (1ull << FirstSegmentBits);
+    unsigned msb = 63 - __builtin_clzll(ip);
+    unsigned s = msb - FirstSegmentBits;
+    std::atomic<CTy*>* seg = segment(s, create);
+    return seg ? &seg[ip - (1ull << msb)] : 0;
+  }
+
+public:
+  BucketVector() {
+    for (unsigned s = 0; s < NumSegments; ++s)
+      segments[s].store(0, std::memory_order_relaxed);
+  }
+
+  ~BucketVector() {
+    for (unsigned s = 0; s < NumSegments; ++s) {
+      std::atomic<CTy*>* seg = segments[s].load(std::memory_order_relaxed);
+      if (!seg)
+        continue;
+      for (size_t i = 0, size = 1ull << (FirstSegmentBits + s); i < size; ++i)
+        delete seg[i].load(std::memory_order_relaxed);
+      delete [] seg;
+    }
+  }
+
+  CTy* get(uint64_t i) {
+    std::atomic<CTy*>* sl = slot(i, false);
+    return sl ? sl->load(std::memory_order_acquire) : 0;
+  }
+
+  //! Returns the bucket for i, creating it if necessary
+  CTy* getOrCreate(uint64_t i) {
+    std::atomic<CTy*>* sl = slot(i, true);
+    CTy* lC = sl->load(std::memory_order_acquire);
+    if (lC)
+      return lC;
+    CTy* fresh = new CTy(i);
+    if (sl->compare_exchange_strong(lC, fresh))
+      return fresh;
+    delete fresh;
+    return lC;
+  }
+};
+
+/**
+ * Hierarchical occupancy bitmap over priorities: a 64-ary tree whose inner
+ * nodes summarize which children have bits set and whose leaves cover 4096
+ * priorities each. Only the owning thread modifies a bitmap, other threads
+ * may search it concurrently; a search racing with an update may miss the
+ * new bit, which is harmless since the owner still finds it.
+ */
+template<unsigned IndexBits>
+class OccupancyBitmap {
+  static const unsigned LeafBits = 12;
+  static const unsigned Levels = (IndexBits - LeafBits + 5) / 6;
+
+  struct Node {
+    std::atomic<uint64_t> summary;
+    //! Leaves: the bits themselves; inner nodes: pointers to children
+    std::atomic<uint64_t> words[64];
+
+    Node() {
+      summary.store(0, std::memory_order_relaxed);
+      for (int i = 0; i < 64; ++i)
+        words[i].store(0, std::memory_order_relaxed);
+    }
+  };
+
+  Node* root;
+  Node* cachedLeaf;
+  uint64_t cachedBase;
+
+  static unsigned shiftOf(unsigned level) { return LeafBits + 6 * (level - 1); }
+  static Node* child(Node* n, unsigned k) {
+    return reinterpret_cast<Node*>(n->words[k].load(std::memory_order_acquire));
+  }
+  static void orBits(std::atomic<uint64_t>& w, uint64_t m) {
+    uint64_t v = w.load(std::memory_order_relaxed);
+    if ((v & m) != m)
+      w.store(v | m, std::memory_order_release);
+  }
+  static uint64_t above(unsigned b) { return b == 63 ? 0 : ~0ull << (b + 1); }
+
+  static void destroy(Node* n, unsigned level) {
+    if (level > 0) {
+      for (unsigned k = 0; k < 64; ++k)
+        if (Node* c = child(n, k))
+          destroy(c, level - 1);
+    }
+    delete n;
+  }
+
+  static uint64_t findLeaf(Node* n, uint64_t base, uint64_t start) {
+    unsigned w = (start >> 6) & 63;
+    uint64_t m = n->words[w].load(std::memory_order_acquire) & (~0ull << (start & 63));
+    if (m)
+      return base + w * 64 + __builtin_ctzll(m);
+    for (uint64_t s = n->summary.load(std::memory_order_acquire) & above(w); s; s &= s - 1) {
+      unsigned w2 = __builtin_ctzll(s);
+      if ((m = n->words[w2].load(std::memory_order_acquire)))
+        return base + w2 * 64 + __builtin_ctzll(m);
+    }
+    return none();
+  }
+
+  static uint64_t find(Node* n, unsigned level, uint64_t base, uint64_t start) {
+    if (level == 0)
+      return findLeaf(n, base, start);
+    unsigned shift = shiftOf(level);
+    unsigned k = (start >> shift) & 63;
+    uint64_t r;
+    Node* c;
+    if ((c = child(n, k)) && (r = find(c, level - 1, base + ((uint64_t) k << shift), start)) != none())
+      return r;
+    for (uint64_t s = n->summary.load(std::memory_order_acquire) & above(k); s; s &= s - 1) {
+      unsigned k2 = __builtin_ctzll(s);
+      uint64_t b2 = base + ((uint64_t) k2 << shift);
+      if ((c = child(n, k2)) && (r = find(c, level - 1, b2, b2)) != none())
+        return r;
+    }
+    return none();
+  }
+
+public:
+  static uint64_t none() { return ~0ull; }
+
+  OccupancyBitmap(): root(new Node()), cachedLeaf(0), cachedBase(0) { }
+  ~OccupancyBitmap() { destroy(root, Levels); }
+
+  //! Owner only
+  void set(uint64_t i) {
+    unsigned w = (i >> 6) & 63;
+    uint64_t bit = 1ull << (i & 63);
+    if (cachedLeaf && (i >> LeafBits) == cachedBase
+        && cachedLeaf->summary.load(std::memory_order_relaxed)) {
+      orBits(cachedLeaf->words[w], bit);
+      orBits(cachedLeaf->summary, 1ull << w);
+      return;
+    }
+    Node* n = root;
+    for (unsigned level = Levels; level > 0; --level) {
+      unsigned k = (i >> shiftOf(level)) & 63;
+      Node* c = child(n, k);
+      if (!c) {
+        c = new Node();
+        n->words[k].store(reinterpret_cast<uint64_t>(c), std::memory_order_release);
+      }
+      orBits(n->summary, 1ull << k);
+      n = c;
+    }
+    orBits(n->words[w], bit);
+    orBits(n->summary, 1ull << w);
+    cachedLeaf = n;
+    cachedBase = i >> LeafBits;
+  }
+
+  //! Owner only
+  void clear(uint64_t i) {
+    Node* path[Levels + 1];
+    Node* n = root;
+    for (unsigned level = Levels; level > 0; --level) {
+      path[level] = n;
+      if (!(n = child(n, (i >> shiftOf(level)) & 63)))
+        return;
+    }
+    unsigned w = (i >> 6) & 63;
+    uint64_t v = n->words[w].load(std::memory_order_relaxed) & ~(1ull << (i & 63));
+    n->words[w].store(v, std::memory_order_relaxed);
+    if (v)
+      return;
+    v = n->summary.load(std::memory_order_relaxed) & ~(1ull << w);
+    n->summary.store(v, std::memory_order_relaxed);
+    for (unsigned level = 1; !v && level <= Levels; ++level) {
+      Node* parent = path[level];
+      v = parent->summary.load(std::memory_order_relaxed) & ~(1ull << ((i >> shiftOf(level)) & 63));
+      parent->summary.store(v, std::memory_order_relaxed);
+    }
+  }
+
+  bool test(uint64_t i) {
+    Node* n = root;
+    for (unsigned level = Levels; level > 0 && n; --level)
+      n = child(n, (i >> shiftOf(level)) & 63);
+    return n && (n->words[(i >> 6) & 63].load(std::memory_order_relaxed) & (1ull << (i & 63)));
+  }
+
+  //! Returns the smallest set index not less than start, or none()
+  uint64_t next(uint64_t start) {
+    if (Levels * 6 + LeafBits < 64 && (start >> (Levels * 6 + LeafBits)))
+      return none();
+    return find(root, Levels, 0, start);
+  }
+};
+
+} // end namespace detail
+
 /**
  * Approximate priority scheduling. Indexer is a default-constructable class
  * whose instances conform to <code>R r = indexer(item)</code> where R is
@@ -56,6 +283,11 @@ namespace WorkList {
  * Galois::for_each<WL>(items.begin(), items.end(), Fn);
  * \endcode
  *
+ * Buckets are kept in an array indexed by priority which grows on demand;
+ * priorities must be non-negative. Each thread keeps an occupancy bitmap of
+ * the buckets it may hold work in, so finding the next non-empty bucket
+ * takes a few bit scans per thread rather than a scan over empty slots.
+ *
  * @tparam Indexer Indexer class
  * @tparam Container Scheduler for each bucket
  * @tparam BlockPeriod Check for higher priority work every 2^BlockPeriod
@@ -95,19 +327,23 @@ private:
   typedef Galois::flat_map<Index, CTy*> LMapTy;
   //typedef std::map<Index, CTy*> LMapTy;
 
+  static const unsigned IndexBits = std::numeric_limits<typename std::make_unsigned<Index>::type>::digits;
+  typedef detail::OccupancyBitmap<IndexBits> Bitmap;
+
   struct perItem {
     LMapTy local;
     Index curIndex;
     Index scanStart;
-    Index scanEnd;
     CTy* current;
     unsigned int lastMasterVersion;
     unsigned int numPops;
+    //! Buckets this thread has pushed to or is working on and has not
+    //! since found empty
+    Bitmap active;
 
     perItem() :
       curIndex(std::numeric_limits<Index>::min()), 
       scanStart(std::numeric_limits<Index>::min()),
-      scanEnd(0),
       current(0), lastMasterVersion(0), numPops(0) { }
   };
 
@@ -125,12 +361,17 @@ private:
     }
   };
 
-  CTy** Q;
-  CTy** QE;
+  detail::BucketVector<CTy, IndexBits> Q;
 
   std::atomic<unsigned int> masterVersion;
   Indexer indexer;
 
+  void setCurrent(perItem& p, CTy* lC, Index i) {
+    p.current = lC;
+    p.curIndex = i;
+    p.active.set(i);
+  }
+
   GALOIS_ATTRIBUTE_NOINLINE
   Galois::optional<T> slowPop(perItem& p) {
     //Failed, find minimum bin
@@ -138,72 +379,55 @@ private:
     bool localLeader = Runtime::LL::isPackageLeaderForSelf(myID);
 
     Index msS = std::numeric_limits<Index>::min();
-    Index endS = 1ull << 25;
     if (BSP) {
       msS = p.scanStart;
-      endS = p.scanEnd;
       if (localLeader || uniformBSP) {
-        for (unsigned i = 0; i < Runtime::activeThreads; ++i) {
+        for (unsigned i = 0; i < Runtime::activeThreads; ++i)
           msS = std::min(msS, current.getRemote(i)->scanStart);
-          endS = std::max(endS, current.getRemote(i)->scanEnd);
-        }
       } else {
         abort();
         msS = std::min(msS, current.getRemote(Runtime::LL::getLeaderForThread(myID))->scanStart);
       }
     }
 
-    CTy** ii;
-    for (ii = &Q[msS]; ii != &Q[endS]; ii++) {
-      if (*ii == 0)
-        continue;
-
+    // A bucket may only hold items if some thread has its bit set: items
+    // are pushed under the pusher's bit, and a thread only clears its bit
+    // after finding the bucket empty, including its own unpublished items
+    uint64_t start = msS < Index() ? 0 : msS;
+    while (true) {
+      uint64_t next = Bitmap::none();
+      for (unsigned i = 0; i < Runtime::activeThreads; ++i)
+        next = std::min(next, current.getRemote(i)->active.next(start));
+      if (next == Bitmap::none())
+        break;
+
+      CTy* lC = Q.get(next);
       Galois::optional<T> retval;
-      if (retval = (*ii)->pop()) {
-        p.current = *ii;
-        p.curIndex = ii - Q;
-        p.scanStart = ii - Q;
+      if (lC && (retval = lC->pop())) {
+        setCurrent(p, lC, next);
+        p.scanStart = next;
         return retval;
       }
+      if (p.active.test(next)) {
+        p.active.clear(next);
+        if (p.current == lC)
+          p.current = 0;
+      }
+      start = next + 1;
     }
     return Galois::optional<value_type>();
   }
 
-  GALOIS_ATTRIBUTE_NOINLINE
-  CTy* slowUpdateLocalOrCreate(perItem& p, Index i) {
-    if (&Q[i] >= QE) abort();
-    CTy* lC = new CTy(i);
-    if (__sync_bool_compare_and_swap(&Q[i], 0, lC)) {
-      return lC;
-    }
-    return Q[i];
-  }
-
   inline CTy* updateLocalOrCreate(perItem& p, Index i) {
-    //Try local then try update then find again or else create and update the master log
-    CTy* lC;
-    if (lC = Q[i])
-      return lC;
-    //slowpath
-    return slowUpdateLocalOrCreate(p, i);
+    assert(!(i < Index()));
+    return Q.getOrCreate(i);
   }
 
 public:
   VectorOrderedByIntegerMetric(const Indexer& x = Indexer()): masterVersion(0), indexer(x) {
-    Q = new CTy*[1ull<<25];
-    QE = &Q[1ull<<25];
-    memset(Q, 0, (1ull<<25) * 8);
     clock.start();
   }
 
-  ~VectorOrderedByIntegerMetric() {
-    CTy **ii;
-
-    for (ii = &Q[0]; ii != QE; ii++) {
-      if (*ii) delete *ii;
-    }
-  }
-
   void push(const value_type& val) {
     Index index = indexer(val);
     perItem& p = *current.getLocal();
@@ -217,13 +441,11 @@ public:
     CTy* lC = updateLocalOrCreate(p, index);
     if (BSP && index < p.scanStart)
       p.scanStart = index;
-    if (index >= p.scanEnd)
-      p.scanEnd = index+1;
     // Opportunistically move to higher priority work
-    if (index < p.curIndex) {
-      p.curIndex = index;
-      p.current = lC;
-    }
+    if (index < p.curIndex)
+      setCurrent(p, lC, index);
+    else
+      p.active.set(index);
     lC->push(val);
   }
 
@@ -48,6 +48,10 @@ struct VisChunkedMaster : private boost::noncopyable {
   template<int _chunk_size>
   struct with_chunk_size { typedef VisChunkedMaster<T, QT, Distributed, IsStack, _chunk_size, Concurrent> type; };
 
+  //! Replaces the queue of full chunks, e.g., with ConExtRingQueue
+  template<template<typename, bool> class _qt>
+  struct with_chunk_queue { typedef VisChunkedMaster<T, _qt, Distributed, IsStack, ChunkSize, Concurrent> type; };
+
 private:
   class Chunk : public FixedSizeRing<T, ChunkSize>, public QT<Chunk, Concurrent>::ListNode {};
 
@@ -25,6 +25,7 @@
 
 #include "Galois/optional.h"
 
+#include "AdaptiveChunked.h"
 #include "AltChunked.h"
 #include "BulkSynchronous.h"
 #include "Chunked.h"
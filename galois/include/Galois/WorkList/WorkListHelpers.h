@@ -29,15 +29,23 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 
+#include <atomic>
 #include <climits>
+#include <type_traits>
 #include "WLCompileCheck.h"
 
+#include "Galois/Threads.h"
+#include "Galois/TypeTraits.h"
+#include "Galois/Runtime/PerThreadStorage.h"
 #include "Galois/Runtime/Termination.h"
 #include "Galois/Runtime/ll/PtrLock.h"
+#include "Galois/Runtime/Support.h"
+#include "Galois/Runtime/mm/Mem.h"
 
 #include "k_lsm/k_lsm.h"
 
 #include <boost/iterator/iterator_facade.hpp>
+#include <boost/noncopyable.hpp>
 #include <boost/heap/d_ary_heap.hpp>
 
 #define MEM_BARRIER     asm volatile("":::"memory")
@@ -187,6 +195,140 @@ public:
   const_iterator end() const { return const_iterator(); }
 };
 
+/**
+ * Lock-free FIFO of externally allocated items: a bounded multi-producer,
+ * multi-consumer ring whose cells carry sequence numbers, so pushes and pops
+ * each take one CAS on their own cache line. Items pushed while the ring is
+ * full go to an overflow {@link ConExtLinkedQueue}, which pops drain once
+ * the ring is empty. Items popped from the ring and from the overflow list
+ * are not ordered with respect to each other.
+ *
+ * Unlike the linked containers, there are no iterators.
+ */
+template<typename T, bool concurrent>
+class ConExtRingQueue : private boost::noncopyable {
+  static const size_t RingSize = 64;
+
+  struct Cell {
+    std::atomic<size_t> seq;
+    T* data;
+  };
+
+  GALOIS_ATTRIBUTE_ALIGN_CACHE_LINE std::atomic<size_t> pushPos;
+  GALOIS_ATTRIBUTE_ALIGN_CACHE_LINE std::atomic<size_t> popPos;
+  GALOIS_ATTRIBUTE_ALIGN_CACHE_LINE Cell cells[RingSize];
+  ConExtLinkedQueue<T, concurrent> overflow;
+
+  bool ringEmpty() const {
+    return popPos.load(std::memory_order_acquire) == pushPos.load(std::memory_order_acquire);
+  }
+
+public:
+  typedef ConExtListNode<T> ListNode;
+
+  ConExtRingQueue(): pushPos(0), popPos(0) {
+    for (size_t i = 0; i < RingSize; ++i)
+      cells[i].seq.store(i, std::memory_order_relaxed);
+  }
+
+  bool empty() const {
+    return ringEmpty() && overflow.empty();
+  }
+
+  //! Approximate number of items in the ring, not counting the overflow list
+  size_t ringSize() const {
+    size_t b = popPos.load(std::memory_order_relaxed);
+    size_t e = pushPos.load(std::memory_order_relaxed);
+    return e > b ? e - b : 0;
+  }
+
+  void push(T* C) {
+    size_t pos = pushPos.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+      cell = &cells[pos & (RingSize - 1)];
+      size_t seq = cell->seq.load(std::memory_order_acquire);
+      intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+      if (diff == 0) {
+        if (pushPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          break;
+      } else if (diff < 0) {
+        overflow.push(C);
+        return;
+      } else {
+        pos = pushPos.load(std::memory_order_relaxed);
+      }
+    }
+    cell->data = C;
+    cell->seq.store(pos + 1, std::memory_order_release);
+  }
+
+  T* pop() {
+    size_t pos = popPos.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+      cell = &cells[pos & (RingSize - 1)];
+      size_t seq = cell->seq.load(std::memory_order_acquire);
+      intptr_t diff = (intptr_t) seq - (intptr_t) (pos + 1);
+      if (diff == 0) {
+        if (popPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+          break;
+      } else if (diff < 0) {
+        return overflow.pop();
+      } else {
+        pos = popPos.load(std::memory_order_relaxed);
+      }
+    }
+    T* C = cell->data;
+    cell->seq.store(pos + RingSize, std::memory_order_release);
+    return C;
+  }
+};
+
+/**
+ * Operators report work wasted on stale or superseded items here (e.g., an
+ * SSSP update whose distance has already been improved). Adaptive-delta
+ * OBIMs narrow their buckets and adaptive chunked worklists shrink their
+ * chunks when too much work is wasted.
+ */
+struct OBIMDeltaFeedback {
+  static void wastedWork(unsigned long n = 1) {
+    *counters().getLocal() += n;
+  }
+
+  static Runtime::PerThreadStorage<unsigned long>& counters() {
+    static Runtime::PerThreadStorage<unsigned long> c;
+    return c;
+  }
+};
+
+namespace detail {
+
+GALOIS_HAS_MEM_FUNC_ANY(peek, tf_peek);
+
+template<typename WL>
+unsigned peekNext(WL& wl, const typename WL::value_type** out, unsigned max, std::true_type) {
+  return wl.peek(out, max);
+}
+
+template<typename WL>
+unsigned peekNext(WL&, const typename WL::value_type**, unsigned, std::false_type) {
+  return 0;
+}
+
+/**
+ * Stores pointers to up to max items that the calling thread will pop next,
+ * in pop order, without popping them; returns their number. The pointers
+ * are valid until the thread next pushes to or pops from wl. Worklists
+ * without a peek method expose no items.
+ */
+template<typename WL>
+unsigned peekNext(WL& wl, const typename WL::value_type** out, unsigned max) {
+  return peekNext(wl, out, max, std::integral_constant<bool, has_tf_peek<WL>::value>());
+}
+
+} // end namespace detail
+
 template<typename T>
 struct DummyIndexer: public std::unary_function<const T&,unsigned> {
   unsigned operator()(const T& x) { return 0; }
@@ -625,16 +767,32 @@ public:
     return key;
   }
 
-  // SCANHEIGHT is what height to start spray at; must be >= 0
-  #define SCANHEIGHT floor_log_2(n)+1
-  // SCANMAX is scanlength at the top level; must be > 0
-  #define SCANMAX floor_log_2(n)+1
+  //! Shape of a spray walk; see Alistarh et al., "The SprayList"
+  struct spray_params {
+    int height;  // level to start the spray at; must be >= 0
+    int scanmax; // max jump length at the top level; must be > 0
+    int padding; // number of bottom-level nodes treated as already skipped
+  };
+
+  //! Spray parameters for a spray width of p (number of threads expected to
+  //! pop concurrently); p == 1 degenerates to a plain delete_min
+  static spray_params spray_params_for(unsigned int p) {
+    spray_params sp;
+    int l = floor_log_2(p);
+    sp.height = l + 1;
+    sp.scanmax = l + 1;
+    sp.padding = p * l / 2;
+    return sp;
+  }
+
   // SCANINC is the amount to increase scan length at each step; can be any integer
   #define SCANINC 0
   //SCANSKIP is # of levels to go down at each step; must be > 0
   #define SCANSKIP 1
 
-  bool try_pop_spray(K& key, unsigned int n, sl_node_t **removed) {
+  //! Pops a node close to the head of the list using a random walk shaped
+  //! by sp. Failed attempts to claim a node are added to *fails.
+  bool try_pop_spray(K& key, const spray_params& sp, sl_node_t **removed, unsigned int* fails) {
     sl_node_t *cur;
 
 retry:
@@ -642,8 +800,8 @@ retry:
     while (1) {
       sl_node_t *next;
       int scanlen;
-      int height = SCANHEIGHT;
-      int scanmax = SCANMAX;
+      int height = sp.height;
+      int scanmax = sp.scanmax;
       int scan_inc = SCANINC;
       int i = height;
       int dummy = 0;
@@ -654,14 +812,14 @@ retry:
         int r = _MarsagliaXOR();
         scanlen = r % (scanmax+1);
 
-        while (dummy < n*floor_log_2(n)/2 && scanlen > 0) {
+        while (dummy < sp.padding && scanlen > 0) {
           dummy += (1 << i);
           scanlen--;
         }
 
         while (scanlen > 0 && cur->next[i]) { // Step right //here: cur->next[0], or cur->next[i]??
           sl_node_t *left = cur, *left_next = cur->next[i];
-          if (is_marked(left_next)) goto retry;
+          if (is_marked(left_next)) { ++*fails; goto retry; }
 
           sl_node_t *right = left_next;
           while (1) {
@@ -671,7 +829,7 @@ retry:
               right = unset_mark(right_next);
           }
           if (left_next != right) {
-            if (!ATOMIC_CAS_MB(&left->next[i], left_next, right)) goto retry;
+            if (!ATOMIC_CAS_MB(&left->next[i], left_next, right)) { ++*fails; goto retry; }
             for (sl_node_t *t = left_next; t != right; t = unset_mark(t->next[i]))
               t->next[i] = set_dead(t->next[i]);
           }
@@ -692,8 +850,10 @@ retry:
         i -= SCANSKIP;
       }
 
-      if (cur == head) // still in dummy range
-        return false; // TODO: clean instead? something else?
+      // Still in the padding range: the walk never left the head, which
+      // happens on short lists. The minimum is the best candidate then.
+      if (cur == head)
+        return try_pop(key);
 
       for (next = cur->next[0]; is_marked(next) && next; ) {
         cur = unset_mark(next); // Find first non-deleted node
@@ -704,6 +864,7 @@ retry:
 
       if (ATOMIC_CAS_MB(&cur->next[0], next, set_mark(next)))
         break;
+      ++*fails;
     }
 
     key = (cur->key);
@@ -735,9 +896,30 @@ __thread bool LockFreeSkipList<Comparer,K>::spray_seed_init;
 template<class Comparer, typename K>
 class SprayList : public LockFreeSkipList<Comparer, K> {
 
+  typedef LockFreeSkipList<Comparer, K> Super;
   typedef SkipListNode<K> sl_node_t;
+  typedef typename Super::spray_params spray_params;
+
+  //! Pops between re-evaluations of the spray width
+  static const unsigned int ADAPT_PERIOD = 64;
+  //! Local size changes folded into the global estimate at a time
+  static const long SIZE_FOLD = 32;
+  //! Sprayed nodes accumulated before a cleanup pass
+  static const unsigned int CLEANUP_BATCH = 32;
+
+  struct ThreadState {
+    sl_node_t* removed;     // nodes popped by spray, not yet reclaimed
+    unsigned int nremoved;  // length of removed
+    unsigned int threshold; // nremoved that triggers the next cleanup
+    unsigned int width;     // current spray width
+    unsigned int pops;      // pops in the current adaptation period
+    unsigned int fails;     // failed claims in the current adaptation period
+    long sizeDelta;         // pushes - pops not yet folded into approxSize
+    ThreadState(): removed(0), nremoved(0), threshold(CLEANUP_BATCH), width(0), pops(0), fails(0), sizeDelta(0) { }
+  };
 
-  Runtime::PerThreadStorage<sl_node_t*> removedNodes;
+  Runtime::PerThreadStorage<ThreadState> state;
+  Runtime::LL::CacheLineStorage<std::atomic<long> > approxSize;
 
   static bool node_linked(sl_node_t *n) {
     for (int i = n->toplevel - 1; i >= 0; i--) {
@@ -749,11 +931,12 @@ class SprayList : public LockFreeSkipList<Comparer, K> {
 
   // check if nodes removed by spray have become unlinked
   // in the mean time, and reclaim them if so
-  void cleanup(sl_node_t **head) {
-    sl_node_t **prev = head;
+  void cleanup(ThreadState& ts) {
+    sl_node_t **prev = &ts.removed;
     sl_node_t *n = *prev;
     sl_node_t *s = NULL;
     int maxlev = 0;
+    unsigned int remaining = 0;
 
     while (n) {
       sl_node_t *next = n->dummy;
@@ -763,6 +946,7 @@ class SprayList : public LockFreeSkipList<Comparer, K> {
         this->sl_delete_node(n);
       } else {
         prev = &n->dummy;
+        ++remaining;
         if (n->toplevel > maxlev) {
           maxlev = n->toplevel;
           s = n;
@@ -772,21 +956,81 @@ class SprayList : public LockFreeSkipList<Comparer, K> {
     }
     if (s)
       this->fraser_search(s->key, NULL, NULL, s);
+
+    // Nodes still linked are revisited only after another full batch so
+    // that the cost of a pass stays proportional to the pops it covers
+    ts.nremoved = remaining;
+    ts.threshold = remaining + CLEANUP_BATCH;
+  }
+
+  void updateSize(ThreadState& ts, long delta) {
+    ts.sizeDelta += delta;
+    if (ts.sizeDelta >= SIZE_FOLD || ts.sizeDelta <= -SIZE_FOLD) {
+      approxSize.data.fetch_add(ts.sizeDelta, std::memory_order_relaxed);
+      ts.sizeDelta = 0;
+    }
+  }
+
+  //! Recomputes the spray width from the failed claim rate of the last
+  //! period and the estimated queue size. Many failed claims mean threads
+  //! collide near the head, so spray wider; few failures let the width
+  //! shrink toward an exact delete_min. The width is also capped so that the
+  //! spray range (roughly p log p nodes) does not exceed the queue itself,
+  //! which keeps small frontiers from being sprayed past.
+  void adapt(ThreadState& ts, unsigned int nthreads) {
+    if (ts.fails * 4 > ts.pops)
+      ts.width = std::min(ts.width * 2, nthreads);
+    else if (ts.fails * 16 < ts.pops && ts.width > 1)
+      ts.width /= 2;
+
+    long size = approxSize.data.load(std::memory_order_relaxed);
+    while (ts.width > 1 && (long) ts.width * (Super::floor_log_2(ts.width) + 1) > size)
+      ts.width /= 2;
+
+    ts.pops = 0;
+    ts.fails = 0;
   }
 
 public:
 
+  SprayList() {
+    approxSize.data = 0;
+  }
+
+  bool push(const K& key) {
+    bool r = Super::push(key);
+    if (r)
+      updateSize(*state.getLocal(), 1);
+    return r;
+  }
+
   bool try_pop(K& key) {
     unsigned int n = Galois::getActiveThreads();
-    sl_node_t **removed = removedNodes.getLocal();
+    ThreadState& ts = *state.getLocal();
 
-    int r = LockFreeSkipList<Comparer,K>::_MarsagliaXOR();
-    if (n == 1 || (r % n) == 0) { // n == 1 is equivalent to Lotan-Shavit delete_min
-      cleanup(removed);
-      return LockFreeSkipList<Comparer,K>::try_pop(key);
+    if (!ts.width || ts.width > n)
+      ts.width = n;
+    if (++ts.pops >= ADAPT_PERIOD)
+      adapt(ts, n);
+
+    if (ts.nremoved >= ts.threshold)
+      cleanup(ts);
+
+    bool r;
+    unsigned int p = ts.width;
+    int rnd = LockFreeSkipList<Comparer,K>::_MarsagliaXOR();
+    if (p == 1 || (rnd % p) == 0) { // p == 1 is equivalent to Lotan-Shavit delete_min
+      r = Super::try_pop(key);
+    } else {
+      sl_node_t* old = ts.removed;
+      r = this->try_pop_spray(key, Super::spray_params_for(p), &ts.removed, &ts.fails);
+      if (ts.removed != old)
+        ++ts.nremoved;
     }
 
-    return this->try_pop_spray(key, n, removed);
+    if (r)
+      updateSize(ts, -1);
+    return r;
   }
 };
 
@@ -1480,15 +1724,55 @@ template<class Comparer, typename K, typename V>
 __thread bool LockFreeSkipListSet<Comparer,K,V>::seeds_init;
 
 
+//! k-LSM relaxed priority queue. Items are ordered by the value Indexer
+//! returns for them, which may be any type supported by kpq::key_traits:
+//! integers of any width or lexicographically ordered pairs, e.g.
+//! (priority, node) to break ties deterministically.
+//!
+//! Rlx bounds the relaxation; the relaxation actually used is taken from
+//! kLSMConfig::get() when the queue is constructed, so a single instantiation
+//! covers any k up to Rlx. Peak live and retained memory are reported as
+//! statistics when the queue is destroyed.
+struct kLSMConfig {
+    int relaxation;      //!< 0 selects the maximal relaxation Rlx
+    bool tune;           //!< adapt the relaxation to contention and rank error
+    size_t memoryBudget; //!< soft limit on retained bytes, 0 for none
+
+    static kLSMConfig& get() {
+        static kLSMConfig config = { 0, false, 0 };
+        return config;
+    }
+};
+
 template<typename K, class Indexer, int Rlx>
 class kLSMQ {
-    // kpq::k_lsm key MUST be unsigned
-    kpq::k_lsm<unsigned long, K, Rlx> pq;
+public:
+    typedef typename std::decay<typename std::result_of<Indexer(const K&)>::type>::type key_type;
+
+private:
+    kpq::k_lsm<key_type, K, Rlx> pq;
     Indexer indexer;
 
 public:
+    kLSMQ() {
+        const kLSMConfig& config = kLSMConfig::get();
+        pq.relaxation().set(config.relaxation > 0 ? config.relaxation : Rlx);
+        pq.relaxation().set_tuning(config.tune);
+        pq.memory().set_limit(config.memoryBudget);
+    }
+
+    ~kLSMQ() {
+        Galois::Runtime::reportStat(0, "kLSMPeakLiveBytes", pq.memory().peak_live());
+        Galois::Runtime::reportStat(0, "kLSMPeakRetainedBytes", pq.memory().peak_retained());
+    }
+
+    //! The relaxation currently in effect
+    int relaxation() {
+        return pq.relaxation().k();
+    }
+
     bool push(const K &key) {
-        pq.insert((unsigned long) indexer(key), key);
+        pq.insert(indexer(key), key);
         return true;
     }
 
@@ -25,6 +25,8 @@
 #include <utility>
 
 #include "item.h"
+#include "key_traits.h"
+#include "simd.h"
 
 namespace kpq
 {
@@ -109,6 +111,10 @@ public:
     void set_unused();
     void set_used();
 
+    /** Makes the calling thread the owner of this (unused) block, which is
+     *  required when blocks are recycled between threads. */
+    void adopt();
+
     void clear();
 
     void print();
@@ -122,6 +128,18 @@ public:
 private:
     static bool item_owned(const block_item &block_item);
 
+    /** Merges the sorted ranges [l, lend) and [r, rend) into dst and returns the
+     *  end of the merged range. On ties, items from r come first. The true_type
+     *  overload is used for 32- and 64-bit integer keys: large merges use the
+     *  SIMD kernel if available, otherwise items are selected arithmetically,
+     *  avoiding a mispredicted branch per item. */
+    static block_item *merge_items(const block_item *l, const block_item *lend,
+                                   const block_item *r, const block_item *rend,
+                                   block_item *dst, std::false_type);
+    static block_item *merge_items(const block_item *l, const block_item *lend,
+                                   const block_item *r, const block_item *rend,
+                                   block_item *dst, std::true_type);
+
 private:
     /** Points to the lowest known filled index. */
     size_t m_first;
@@ -137,7 +155,7 @@ private:
     const size_t m_power_of_2;
     const size_t m_capacity;
 
-    const int32_t m_owner_tid;
+    int32_t m_owner_tid;
 
     block_item *m_block_items;
 
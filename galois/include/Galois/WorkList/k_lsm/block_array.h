@@ -43,13 +43,20 @@ public:
     block_array();
     virtual ~block_array();
 
-    /** May only be called when this block is not visible to other threads. */
+    /** May only be called when this block is not visible to other threads.
+     *  rlx is the current relaxation, see relaxation.h. */
     void insert(block<K, V> *block,
-                block_pool<K, V> *pool);
+                block_pool<K, V> *pool,
+                const int rlx);
 
     /** Callable from other threads. */
-    bool delete_min(V &val);
-    typename block<K, V>::peek_t peek();
+    bool delete_min(V &val,
+                    const int rlx);
+    typename block<K, V>::peek_t peek(const int rlx);
+
+    /** Counts the untaken items within the pivot range with keys smaller than
+     *  the given item's key, i.e. its rank error. Used for relaxation tuning. */
+    size_t rank_of(const typename block<K, V>::peek_t &item) const;
 
     /** Copies the given block array into the current instance.
       * The copy is shallow, i.e. only block pointers are copied. */
@@ -60,12 +67,13 @@ public:
 
 private:
     /** May only be called when this block is not visible to other threads. */
-    void compact(block_pool<K, V> *pool);
+    void compact(block_pool<K, V> *pool,
+                 const int rlx);
     void remove_null_blocks();
 
     /** Utility functions for mutating blocks together with pivots. */
-    void block_insert(const size_t block_ix, block<K, V> *block);
-    void block_set(const size_t block_ix, block<K, V> *block);
+    void block_insert(const size_t block_ix, block<K, V> *block, const int rlx);
+    void block_set(const size_t block_ix, block<K, V> *block, const int rlx);
 
 private:
 
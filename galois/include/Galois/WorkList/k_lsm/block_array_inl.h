@@ -40,32 +40,35 @@ block_array<K, V, Rlx>::~block_array()
 template <class K, class V, int Rlx>
 void
 block_array<K, V, Rlx>::block_insert(const size_t block_ix,
-                                     block<K, V> *block)
+                                     block<K, V> *block,
+                                     const int rlx)
 {
     memmove(&m_blocks[block_ix + 1],
             &m_blocks[block_ix],
             sizeof(m_blocks[0]) * (m_size - block_ix));
     m_blocks[block_ix] = block;
-    m_pivots.insert(block_ix, m_size, block->first(), m_pivots.pivot_of(block));
+    m_pivots.insert(block_ix, m_size, block->first(), m_pivots.pivot_of(block, rlx));
 }
 
 template <class K, class V, int Rlx>
 void
 block_array<K, V, Rlx>::block_set(const size_t block_ix,
-                                  block<K, V> *block)
+                                  block<K, V> *block,
+                                  const int rlx)
 {
     // TODO: More efficient pivot recalculation.
     m_blocks[block_ix] = block;
-    m_pivots.set(block_ix, block->first(), m_pivots.pivot_of(block));
+    m_pivots.set(block_ix, block->first(), m_pivots.pivot_of(block, rlx));
 }
 
 template <class K, class V, int Rlx>
 void
 block_array<K, V, Rlx>::insert(block<K, V> *new_block,
-                               block_pool<K, V> *pool)
+                               block_pool<K, V> *pool,
+                               const int rlx)
 {
     if (m_size == 0) {
-        block_set(0, new_block);
+        block_set(0, new_block, rlx);
     } else {
         size_t i;
         for (i = 0; i < m_size; i++) {
@@ -98,28 +101,29 @@ block_array<K, V, Rlx>::insert(block<K, V> *new_block,
                 m_blocks[i - 1] = nullptr;
             }
         }
-        block_insert(i, insert_block);
+        block_insert(i, insert_block, rlx);
     }
 
     m_size++;
-    compact(pool);
+    compact(pool, rlx);
 
     /* If the number of elements within the pivot range is smaller than our lower bound,
      * attempt to improve pivots. */
 
     const size_t ncandidates = m_pivots.count(m_size);
-    if (ncandidates > Rlx + 1) {
+    if (ncandidates > rlx + 1) {
         // TODO: Possibly a more efficient reset mechanism which uses knowledge of existing
         // pivots.
-        m_pivots.shrink(m_blocks, m_size);
-    } else if (ncandidates < Rlx / 2) {
-        m_pivots.grow(ncandidates, m_blocks, m_size);
+        m_pivots.shrink(m_blocks, m_size, rlx);
+    } else if (ncandidates < rlx / 2) {
+        m_pivots.grow(ncandidates, m_blocks, m_size, rlx);
     }
 }
 
 template <class K, class V, int Rlx>
 void
-block_array<K, V, Rlx>::compact(block_pool<K, V> *pool)
+block_array<K, V, Rlx>::compact(block_pool<K, V> *pool,
+                                const int rlx)
 {
     remove_null_blocks();
 
@@ -140,7 +144,7 @@ block_array<K, V, Rlx>::compact(block_pool<K, V> *pool)
 
             auto shrunk = pool->get_block(shrunk_power_of_2);
             shrunk->copy(b);
-            block_set(i, shrunk);
+            block_set(i, shrunk, rlx);
 
             COUNT_INC(block_shrinks);
         }
@@ -168,7 +172,7 @@ block_array<K, V, Rlx>::compact(block_pool<K, V> *pool)
         merge_block->merge(big_block, big_first, small_block, small_first);
 
         m_blocks[i + 1] = nullptr;
-        block_set(i, merge_block);
+        block_set(i, merge_block, rlx);
     }
 
     remove_null_blocks();
@@ -201,9 +205,10 @@ block_array<K, V, Rlx>::remove_null_blocks() {
 
 template <class K, class V, int Rlx>
 bool
-block_array<K, V, Rlx>::delete_min(V &val)
+block_array<K, V, Rlx>::delete_min(V &val,
+                                   const int rlx)
 {
-    typename block<K, V>::peek_t best = peek();
+    typename block<K, V>::peek_t best = peek(rlx);
 
     if (best.m_item == nullptr) {
         return false; /* We did our best, give up. */
@@ -214,7 +219,7 @@ block_array<K, V, Rlx>::delete_min(V &val)
 
 template <class K, class V, int Rlx>
 typename block<K, V>::peek_t
-block_array<K, V, Rlx>::peek()
+block_array<K, V, Rlx>::peek(const int rlx)
 {
     /* Random selection of any item within the range given by the pivots.
      * First, calculate the number of items within the range. We need to store
@@ -229,8 +234,8 @@ block_array<K, V, Rlx>::peek()
 
         /* If the range contains too few items, attempt to improve it. */
 
-        if (ncandidates < Rlx / 2) {
-            ncandidates = m_pivots.grow(ncandidates, m_blocks, m_size);
+        if (ncandidates < rlx / 2) {
+            ncandidates = m_pivots.grow(ncandidates, m_blocks, m_size, rlx);
         }
 
         /* Select a random element within the range, find it, and return it. */
@@ -299,6 +304,29 @@ block_array<K, V, Rlx>::peek()
     }
 }
 
+template <class K, class V, int Rlx>
+size_t
+block_array<K, V, Rlx>::rank_of(const typename block<K, V>::peek_t &item) const
+{
+    size_t rank = 0;
+    for (size_t block_ix = 0; block_ix < m_size; block_ix++) {
+        const auto b = m_blocks[block_ix];
+        const size_t first = m_pivots.nth_ix_in(0, block_ix);
+        const size_t count = m_pivots.count_in(block_ix);
+
+        /* Blocks are sorted, stop at the first key which is not smaller. */
+        auto it = b->peek_nth(first);
+        for (size_t i = 0; i < count; i++, it++) {
+            if (!(it->m_key < item.m_key)) {
+                break;
+            } else if (!it->taken()) {
+                rank++;
+            }
+        }
+    }
+    return rank;
+}
+
 template <class K, class V, int Rlx>
 void
 block_array<K, V, Rlx>::copy_from(const block_array<K, V, Rlx> *that)
@@ -140,13 +140,8 @@ block<K, V>::merge(const block<K, V> *lhs,
     const auto lend = lhs->m_block_items + lhs_last;
     const auto rend = rhs->m_block_items + rhs_last;
 
-    auto dst = m_block_items;
-    while (l < lend && r < rend) {
-        *dst++ = (l->m_key < r->m_key) ? *l++ : *r++;
-    }
-
-    while (l < lend) *dst++ = *l++;
-    while (r < rend) *dst++ = *r++;
+    auto dst = merge_items(l, lend, r, rend, m_block_items,
+                           std::integral_constant<bool, key_traits<K>::branchless_merge>());
 
     /* Prune. */
 
@@ -173,6 +168,47 @@ block<K, V>::merge(const block<K, V> *lhs,
     assert(m_last <= m_capacity);
 }
 
+template <class K, class V>
+typename block<K, V>::block_item *
+block<K, V>::merge_items(const block_item *l, const block_item *lend,
+                         const block_item *r, const block_item *rend,
+                         block_item *dst, std::false_type)
+{
+    while (l < lend && r < rend) {
+        *dst++ = (l->m_key < r->m_key) ? *l++ : *r++;
+    }
+
+    while (l < lend) *dst++ = *l++;
+    while (r < rend) *dst++ = *r++;
+
+    return dst;
+}
+
+template <class K, class V>
+typename block<K, V>::block_item *
+block<K, V>::merge_items(const block_item *l, const block_item *lend,
+                         const block_item *r, const block_item *rend,
+                         block_item *dst, std::true_type)
+{
+    if (lend - l >= (ptrdiff_t)simd::MERGE_THRESHOLD
+            && rend - r >= (ptrdiff_t)simd::MERGE_THRESHOLD
+            && simd::use_avx2()) {
+        return simd::merge(l, lend, r, rend, dst);
+    }
+
+    while (l < lend && r < rend) {
+        const bool take_l = l->m_key < r->m_key;
+        *dst++ = *(take_l ? l : r);
+        l += take_l;
+        r += !take_l;
+    }
+
+    while (l < lend) *dst++ = *l++;
+    while (r < rend) *dst++ = *r++;
+
+    return dst;
+}
+
 template <class K, class V>
 void
 block<K, V>::copy(const block<K, V> *that)
@@ -353,6 +389,14 @@ block<K, V>::set_used()
     m_used = true;
 }
 
+template <class K, class V>
+void
+block<K, V>::adopt()
+{
+    assert(!m_used);
+    m_owner_tid = Galois::Runtime::LL::getTID();
+}
+
 template <class K, class V>
 bool
 block<K, V>::item_owned(const block_item &block_item)
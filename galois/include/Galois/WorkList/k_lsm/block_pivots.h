@@ -20,6 +20,9 @@
 #ifndef __BLOCK_PIVOTS_H
 #define __BLOCK_PIVOTS_H
 
+#include "key_traits.h"
+#include "simd.h"
+
 namespace kpq {
 
 // TODO: Better naming, pivots is very undescriptive to me. Item range? Index boundaries
@@ -34,11 +37,15 @@ public:
 
     block_pivots &operator=(const block_pivots<K, V, Rlx, MaxBlocks> &that);
 
+    /** Both shrink() and grow() aim for a pivot range containing between
+     *  rlx / 2 and rlx + 1 items, where rlx is the current relaxation. */
     size_t shrink(block<K, V> **blocks,
-                  const size_t size);
+                  const size_t size,
+                  const int rlx);
     size_t grow(const int initial_range_size,
                 block<K, V> **blocks,
-                const size_t size);
+                const size_t size,
+                const int rlx);
 
     /** Counts the number of elements within the pivot range. */
     size_t count(const size_t size);
@@ -49,7 +56,8 @@ public:
 
     void mark_first_taken_in(const size_t block_ix);
 
-    int pivot_of(block<K, V> *block) const;
+    int pivot_of(block<K, V> *block,
+                 const int rlx) const;
 
     void insert(const size_t block_ix,
                 const size_t size,
@@ -63,7 +71,8 @@ private:
                   const K initial_lower_bound,
                   const K initial_upper_bound,
                   block<K, V> **blocks,
-                  const size_t size);
+                  const size_t size,
+                  const int rlx);
 
 private:
     static constexpr size_t INVALID_COUNT_FOR_SIZE = -1;
@@ -17,13 +17,11 @@
  *  along with kpqueue.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <limits>
-
 template <class K, class V, int Rlx, int MaxBlocks>
 block_pivots<K, V, Rlx, MaxBlocks>::block_pivots() :
     m_upper { 0 },
     m_lower { 0 },
-    m_maximal_pivot(std::numeric_limits<K>::min()),
+    m_maximal_pivot(key_traits<K>::min()),
     m_count { 0 },
     m_count_for_size { INVALID_COUNT_FOR_SIZE }
 {
@@ -51,7 +49,8 @@ block_pivots<K, V, Rlx, MaxBlocks>::operator=(const block_pivots<K, V, Rlx, MaxB
 template <class K, class V, int Rlx, int MaxBlocks>
 size_t
 block_pivots<K, V, Rlx, MaxBlocks>::shrink(block<K, V> **blocks,
-                                           const size_t size)
+                                           const size_t size,
+                                           const int rlx)
 {
     COUNT_INC(pivot_shrinks);
 
@@ -91,22 +90,25 @@ block_pivots<K, V, Rlx, MaxBlocks>::shrink(block<K, V> **blocks,
                   best.m_key,
                   m_maximal_pivot,
                   blocks,
-                  size);
+                  size,
+                  rlx);
 }
 
 template <class K, class V, int Rlx, int MaxBlocks>
 size_t
 block_pivots<K, V, Rlx, MaxBlocks>::grow(const int initial_range_size,
                                          block<K, V> **blocks,
-                                         const size_t size)
+                                         const size_t size,
+                                         const int rlx)
 {
     COUNT_INC(pivot_grows);
 
     return resize(initial_range_size,
                   m_maximal_pivot,
-                  std::numeric_limits<K>::max(),
+                  key_traits<K>::max(),
                   blocks,
-                  size);
+                  size,
+                  rlx);
 }
 
 #define CORRECTED_TENTATIVE_COUNT() (elements_in_tentative_range + 1 - elements_with_maximal_key)
@@ -117,7 +119,8 @@ block_pivots<K, V, Rlx, MaxBlocks>::resize(const int initial_range_size,
                                            const K initial_lower_bound,
                                            const K initial_upper_bound,
                                            block<K, V> **blocks,
-                                           const size_t size)
+                                           const size_t size,
+                                           const int rlx)
 {
     /* During iterative improvement of pivots, we may repeatedly go beyond legal
      * limits and must backtrack the previous solution. For that purpose, we
@@ -143,12 +146,12 @@ block_pivots<K, V, Rlx, MaxBlocks>::resize(const int initial_range_size,
             goto out;
         }
 
-        mid = lower_bound + (upper_bound - lower_bound) / 2;
+        mid = key_traits<K>::midpoint(lower_bound, upper_bound);
 
         // Used to 1) obtain better bounds for next iteration, and 2) count
         // the number of items with the maximal encountered key - all but one of these
         // may be ignored for the sake of relaxation bounds.
-        K maximal_key = std::numeric_limits<K>::min();
+        K maximal_key = key_traits<K>::min();
         int elements_with_maximal_key = 0;
 
         elements_in_tentative_range = elements_in_range;
@@ -161,14 +164,16 @@ block_pivots<K, V, Rlx, MaxBlocks>::resize(const int initial_range_size,
                 continue;
             }
 
+            /* Keys within a block stay sorted even once taken, locate the
+             * end of the candidate range before checking ownership. */
+            const int bound = simd::upper_bound(b->peek_nth(0), pivot, last, mid);
+
             auto it = b->peek_nth(pivot);
-            const auto end = it + last - pivot;
+            const auto end = it + bound - pivot;
             for (; it < end; it++, pivot++) {
                 K key = it->m_key;
                 if (it->taken()) {
                     continue;
-                } else if (key > mid) {
-                    break;
                 } else {
                     elements_in_tentative_range++;
                     if (key > maximal_key) {
@@ -179,7 +184,7 @@ block_pivots<K, V, Rlx, MaxBlocks>::resize(const int initial_range_size,
                     }
                 }
 
-                if (CORRECTED_TENTATIVE_COUNT() > Rlx + 1) {
+                if (CORRECTED_TENTATIVE_COUNT() > rlx + 1) {
                     tentative_pivots[block_ix] = pivot;
                     goto outer;
                 }
@@ -188,12 +193,12 @@ block_pivots<K, V, Rlx, MaxBlocks>::resize(const int initial_range_size,
         }
 
 outer:
-        if (CORRECTED_TENTATIVE_COUNT() > Rlx + 1) {
+        if (CORRECTED_TENTATIVE_COUNT() > rlx + 1) {
             if (upper_bound == mid) {
                 goto out;
             }
             upper_bound = std::min(mid, maximal_key);
-        } else if (elements_in_tentative_range < Rlx / 2) {
+        } else if (elements_in_tentative_range < rlx / 2) {
             if (lower_bound == mid) {
                 break;  // Could not improve solution further.
             }
@@ -273,10 +278,11 @@ block_pivots<K, V, Rlx, MaxBlocks>::mark_first_taken_in(const size_t block_ix)
 
 template <class K, class V, int Rlx, int MaxBlocks>
 int
-block_pivots<K, V, Rlx, MaxBlocks>::pivot_of(block<K, V> *block) const
+block_pivots<K, V, Rlx, MaxBlocks>::pivot_of(block<K, V> *block,
+                                             const int rlx) const
 {
     const size_t first = block->first();
-    const size_t upper_bound = std::min(first + Rlx + 1, block->last());
+    const size_t upper_bound = std::min(first + rlx + 1, block->last());
     for (size_t i = first; i < upper_bound; i++) {
         auto p = block->peek_nth(i);
         if (!p->taken() && p->m_key > m_maximal_pivot) {
@@ -21,6 +21,8 @@
 #define __BLOCK_POOL_H
 
 #include "block.h"
+#include "block_recycler.h"
+#include "mm.h"
 
 #include <algorithm>
 
@@ -40,17 +42,28 @@ private:
     };
 
 public:
-    block_pool() :
+    /** Blocks are allocated through the recycler if given. Blocks which are
+     *  local or global count as live. */
+    block_pool(block_recycler<K, V> *recycler = nullptr) :
         m_pool { nullptr },
         m_status { BLOCK_FREE },
         m_version { 0 },
-        m_local_ixs_size { 0 }
+        m_local_ixs_size { 0 },
+        m_recycler(recycler),
+        m_live(recycler == nullptr ? nullptr : &recycler->budget())
     {
     }
 
     virtual ~block_pool() {
         for (int i = 0; i < BLOCKS_IN_POOL; i++) {
-            delete m_pool[i];
+            if (m_pool[i] == nullptr) {
+                continue;
+            } else if (m_recycler == nullptr) {
+                delete m_pool[i];
+            } else {
+                m_pool[i]->set_unused();
+                m_recycler->release(m_pool[i]);
+            }
         }
     }
 
@@ -60,24 +73,21 @@ public:
         /* Find the maximum version of globally allocated blocks.
          * It is safe to reallocate any but the most recent global block.
          * We could optimize this loop out in the future. */
-        int max_global_version = -1;
-        for (int j = ix(i); j < ix(i + 1); j++) {
-            if (m_status[j] == BLOCK_GLOBAL) {
-                max_global_version = std::max(max_global_version, (int)m_version[j]);
-            }
-        }
+        const int max_global_version = max_global_version_of(i);
 
         for (int j = ix(i); j < ix(i + 1); j++) {
-            if (m_status[j] == BLOCK_FREE
-                    || (m_status[j] == BLOCK_GLOBAL
-                        && (int)m_version[j] != max_global_version)) {
+            if (reusable(j, max_global_version)) {
+                if (m_status[j] == BLOCK_FREE) {
+                    m_live.add(block_recycler<K, V>::bytes(i));
+                }
                 m_status[j] = BLOCK_LOCAL;
                 m_local_ixs[m_local_ixs_size++] = j;
                 if (m_pool[j] == nullptr) {
                     /* Lazy block creation.
                      * 'used' is not needed for the shared lsm. Figure out a way for both
                      * mechanisms to interact when integrating shared & dist lsm's. */
-                    m_pool[j] = new block<K, V>(i);
+                    m_pool[j] = (m_recycler == nullptr) ? new block<K, V>(i)
+                                                        : m_recycler->acquire(i);
                     m_pool[j]->set_used();
                 } else {
                     m_pool[j]->clear();
@@ -123,6 +133,7 @@ public:
                 that_ix = ix;
             } else if (m_status[ix] == BLOCK_LOCAL) {
                 m_status[ix] = BLOCK_FREE;
+                m_live.add(-(ptrdiff_t)block_recycler<K, V>::bytes(m_pool[ix]->power_of_2()));
             }
         }
 
@@ -136,7 +147,54 @@ public:
         return (find(block) != -1);
     }
 
+    /** Returns all blocks which get_block() could reuse to the recycler.
+     *  May not be called while an insertion is in progress. */
+    void trim()
+    {
+        assert(m_local_ixs_size == 0);
+        if (m_recycler == nullptr) {
+            return;
+        }
+
+        for (int i = 0; i < MAX_POWER_OF_2; i++) {
+            const int max_global_version = max_global_version_of(i);
+            for (int j = ix(i); j < ix(i + 1); j++) {
+                if (m_pool[j] == nullptr || !reusable(j, max_global_version)) {
+                    continue;
+                }
+
+                if (m_status[j] == BLOCK_GLOBAL) {
+                    m_live.add(-(ptrdiff_t)block_recycler<K, V>::bytes(i));
+                }
+                m_pool[j]->set_unused();
+                m_recycler->release(m_pool[j]);
+                m_pool[j] = nullptr;
+                m_status[j] = BLOCK_FREE;
+            }
+        }
+        m_live.flush();
+    }
+
 private:
+    /** It is safe to reallocate any but the most recent global block. */
+    int max_global_version_of(const size_t i) const
+    {
+        int max_global_version = -1;
+        for (int j = ix(i); j < ix(i + 1); j++) {
+            if (m_status[j] == BLOCK_GLOBAL) {
+                max_global_version = std::max(max_global_version, (int)m_version[j]);
+            }
+        }
+        return max_global_version;
+    }
+
+    bool reusable(const int j, const int max_global_version) const
+    {
+        return m_status[j] == BLOCK_FREE
+                || (m_status[j] == BLOCK_GLOBAL
+                    && (int)m_version[j] != max_global_version);
+    }
+
     int find(const block<K, V> *block) const
     {
         const int pow = block->power_of_2();
@@ -164,6 +222,9 @@ private:
      *  All other indexes are guaranteed not to be set to LOCAL. */
     size_t m_local_ixs_size;
     int m_local_ixs[BLOCKS_IN_POOL];
+
+    block_recycler<K, V> *m_recycler;
+    live_counter m_live;
 };
 
 }
@@ -0,0 +1,123 @@
+/*
+ *  This file is part of kpqueue.
+ *
+ *  kpqueue is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  kpqueue is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with kpqueue.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __BLOCK_RECYCLER_H
+#define __BLOCK_RECYCLER_H
+
+#include <vector>
+
+#include "block.h"
+#include "item.h"
+#include "mm.h"
+
+namespace kpq
+{
+
+/**
+ * The memory shared by all components of a single k-lsm: idle blocks of
+ * each size, idle item chunks and the memory budget accounting for both.
+ *
+ * Thread-local block pools (block_storage in the dist lsm, block_pool in the
+ * shared lsm) allocate through the recycler and hand their idle blocks back
+ * once their thread runs out of work, or immediately while the budget is
+ * exceeded. Blocks and chunks are only freed when the recycler is destroyed:
+ * other threads may still read a block through a stale pointer, which is
+ * safe for reused memory (items are validated by their version) but not for
+ * freed memory.
+ */
+
+template <class K, class V>
+class block_recycler
+{
+public:
+    typedef typename item_allocator<item<K, V>,
+                                    typename item<K, V>::reuse>::pool_type item_pool;
+
+    static constexpr size_t MAX_POWER_OF_2 = 48;
+
+    block_recycler() :
+        m_items(&m_budget)
+    {
+    }
+
+    ~block_recycler()
+    {
+        for (size_t i = 0; i < MAX_POWER_OF_2; i++) {
+            for (auto b : m_levels[i].m_blocks) {
+                delete b;
+            }
+        }
+    }
+
+    /** Returns an unused block of capacity 2^i, owned by the calling thread. */
+    block<K, V> *acquire(const size_t i)
+    {
+        assert(i < MAX_POWER_OF_2);
+        auto &level = m_levels[i];
+
+        block<K, V> *b = nullptr;
+        level.m_lock.lock();
+        if (!level.m_blocks.empty()) {
+            b = level.m_blocks.back();
+            level.m_blocks.pop_back();
+        }
+        level.m_lock.unlock();
+
+        if (b == nullptr) {
+            b = new block<K, V>(i);
+            m_budget.retain(bytes(i));
+        } else {
+            b->adopt();
+        }
+        return b;
+    }
+
+    /** Takes back an unused block. */
+    void release(block<K, V> *b)
+    {
+        assert(!b->used());
+        auto &level = m_levels[b->power_of_2()];
+
+        level.m_lock.lock();
+        level.m_blocks.push_back(b);
+        level.m_lock.unlock();
+    }
+
+    /** The memory occupied by a block of capacity 2^i. */
+    static size_t bytes(const size_t i)
+    {
+        return sizeof(block<K, V>)
+                + (size_t(1) << i) * sizeof(typename block<K, V>::block_item);
+    }
+
+    memory_budget &budget() { return m_budget; }
+    item_pool &items() { return m_items; }
+
+private:
+    struct level {
+        Galois::Runtime::LL::SimpleLock<true> m_lock;
+        std::vector<block<K, V> *> m_blocks;
+    };
+
+    memory_budget m_budget;
+    item_pool m_items;
+    level m_levels[MAX_POWER_OF_2];
+};
+
+}
+
+#endif /* __BLOCK_RECYCLER_H */
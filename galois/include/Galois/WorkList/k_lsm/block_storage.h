@@ -23,12 +23,15 @@
 #include <cassert>
 
 #include "block.h"
+#include "block_recycler.h"
+#include "mm.h"
 
 namespace kpq
 {
 
 /**
- * Maintains N-tuples of memory blocks of size 2^i.
+ * Maintains N-tuples of memory blocks of size 2^i. Blocks are allocated
+ * lazily, through the recycler if one is given.
  */
 
 template <class K, class V, int N>
@@ -42,22 +45,42 @@ private:
     };
 
 public:
-    block_storage() : m_blocks { { nullptr } }, m_size(0) { }
+    block_storage(block_recycler<K, V> *recycler = nullptr) :
+        m_blocks { { nullptr } },
+        m_size(0),
+        m_recycler(recycler),
+        m_live(recycler == nullptr ? nullptr : &recycler->budget())
+    {
+    }
     virtual ~block_storage();
 
     /**
-     * Returns an unused block of size 2^i. If such a block does not exist,
-     * a new N-tuple of size 2^i is allocated.
+     * Returns an unused block of size 2^i. If the tuple of size 2^i has no
+     * unused block, a free slot of it is filled with a new block.
      */
     block<K, V> *get_block(const size_t i);
 
     block<K, V> *get_largest_block();
 
+    /** Marks a block returned by get_block() as unused. While the memory
+     *  budget is exceeded, it is returned to the recycler right away. */
+    void release(block<K, V> *block);
+
+    /** Returns all unused blocks to the recycler. */
+    void trim();
+
     void print() const;
 
+private:
+    block<K, V> *&slot_of(const block<K, V> *block);
+    void recycle(block<K, V> *&slot);
+
 private:
     block_tuple m_blocks[MAX_BLOCKS];
     size_t m_size;
+
+    block_recycler<K, V> *m_recycler;
+    live_counter m_live;
 };
 
 #include "block_storage_inl.h"
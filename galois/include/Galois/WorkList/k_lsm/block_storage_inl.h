@@ -22,7 +22,17 @@ block_storage<K, V, N>::~block_storage()
 {
     for (size_t i = 0; i < m_size; i++) {
         for (int j = 0; j < N; j++) {
-            delete m_blocks[i].xs[j];
+            auto &slot = m_blocks[i].xs[j];
+            if (slot == nullptr) {
+                continue;
+            } else if (m_recycler == nullptr) {
+                delete slot;
+            } else {
+                if (slot->used()) {
+                    slot->set_unused();
+                }
+                m_recycler->release(slot);
+            }
         }
     }
 }
@@ -31,23 +41,78 @@ template <class K, class V, int N>
 block<K, V> *
 block_storage<K, V, N>::get_block(const size_t i)
 {
-    for (; m_size <= i; m_size++) {
-        /* Alloc new blocks. */
+    m_size = std::max(m_size, i + 1);
+
+    block<K, V> **slot = &m_blocks[i].xs[N - 1];
+    for (int j = 0; j < N; j++) {
+        auto &candidate = m_blocks[i].xs[j];
+        if (candidate == nullptr || !candidate->used()) {
+            slot = &candidate;
+            break;
+        }
+    }
+
+    if (*slot == nullptr) {
+        *slot = (m_recycler == nullptr) ? new block<K, V>(i)
+                                        : m_recycler->acquire(i);
+    }
+
+    (*slot)->set_used();
+    m_live.add(block_recycler<K, V>::bytes(i));
+    return *slot;
+}
+
+template <class K, class V, int N>
+void
+block_storage<K, V, N>::release(block<K, V> *block)
+{
+    block->set_unused();
+    m_live.add(-(ptrdiff_t)block_recycler<K, V>::bytes(block->power_of_2()));
+
+    if (m_recycler != nullptr && m_recycler->budget().exceeded()) {
+        recycle(slot_of(block));
+    }
+}
+
+template <class K, class V, int N>
+void
+block_storage<K, V, N>::trim()
+{
+    if (m_recycler == nullptr) {
+        return;
+    }
+
+    for (size_t i = 0; i < m_size; i++) {
         for (int j = 0; j < N; j++) {
-            m_blocks[m_size].xs[j] = new block<K, V>(m_size);
+            auto &slot = m_blocks[i].xs[j];
+            if (slot != nullptr && !slot->used()) {
+                recycle(slot);
+            }
         }
     }
+    m_live.flush();
+}
 
-    block<K, V> *block = m_blocks[i].xs[N - 1];
+template <class K, class V, int N>
+block<K, V> *&
+block_storage<K, V, N>::slot_of(const block<K, V> *block)
+{
+    auto &tuple = m_blocks[block->power_of_2()];
     for (int j = 0; j < N - 1; j++) {
-        if (!m_blocks[i].xs[j]->used()) {
-            block = m_blocks[i].xs[j];
-            break;
+        if (tuple.xs[j] == block) {
+            return tuple.xs[j];
         }
     }
+    assert(tuple.xs[N - 1] == block);
+    return tuple.xs[N - 1];
+}
 
-    block->set_used();
-    return block;
+template <class K, class V, int N>
+void
+block_storage<K, V, N>::recycle(block<K, V> *&slot)
+{
+    m_recycler->release(slot);
+    slot = nullptr;
 }
 
 template <class K, class V, int N>
@@ -62,11 +127,13 @@ void
 block_storage<K, V, N>::print() const
 {
     for (size_t i = 0; i < m_size; i++) {
-        printf("%zu: {%d", i, m_blocks[i].xs[0]->used());
-        m_blocks[i].xs[0]->print();
-        for (int j = 1; j < N; j++) {
-            printf(", %d", m_blocks[i].xs[j]->used());
-            m_blocks[i].xs[j]->print();
+        printf("%zu: {", i);
+        for (int j = 0; j < N; j++) {
+            auto b = m_blocks[i].xs[j];
+            printf((j == 0) ? "%d" : ", %d", b != nullptr && b->used());
+            if (b != nullptr) {
+                b->print();
+            }
         }
         printf("}, ");
     }
@@ -47,7 +47,9 @@
     D(successful_peeks) \
     D(failed_peeks) \
     D(requested_spies) \
-    D(aborted_spies)
+    D(aborted_spies) \
+    D(rlx_raises) /* Relaxation increases by the tuner. */ \
+    D(rlx_lowers)
 
 namespace kpq
 {
@@ -32,6 +32,12 @@ class dist_lsm
     friend int dist_lsm_local<K, V, Rlx>::spy(dist_lsm<K, V, Rlx> *parent);
 
 public:
+    /** Blocks and items are allocated through the recycler if given. */
+    dist_lsm(block_recycler<K, V> *recycler = nullptr) :
+        m_local(recycler)
+    {
+    }
+
 
     /**
      * Inserts a new item into the local LSM.
@@ -61,6 +67,9 @@ public:
 
     int spy();
 
+    /** Returns the current thread's idle memory to the recycler. */
+    void trim();
+
     void print();
 
     void init_thread(const size_t) const { }
@@ -69,6 +69,13 @@ dist_lsm<K, V, Rlx>::spy()
     return m_local.get()->spy(this);
 }
 
+template <class K, class V, int Rlx>
+void
+dist_lsm<K, V, Rlx>::trim()
+{
+    m_local.get()->trim();
+}
+
 template <class K, class V, int Rlx>
 void
 dist_lsm<K, V, Rlx>::print()
@@ -22,6 +22,7 @@
 
 #include <atomic>
 
+#include "block_recycler.h"
 #include "block_storage.h"
 #include "item.h"
 #include "counters.h"
@@ -41,7 +42,7 @@ template <class K, class V, int Rlx>
 class dist_lsm_local
 {
 public:
-    dist_lsm_local();
+    dist_lsm_local(block_recycler<K, V> *recycler = nullptr);
     virtual ~dist_lsm_local();
 
     void insert(const K &key,
@@ -68,6 +69,10 @@ public:
 
     bool empty() const { return m_head.load(std::memory_order_relaxed) == nullptr; }
 
+    /** Returns idle blocks and item chunks to the recycler. Cheap if nothing
+     *  has been inserted since the last call. */
+    void trim();
+
     void print() const;
 
 private:
@@ -96,6 +101,9 @@ private:
     typename block<K, V>::peek_t m_cached_best;
 
     xorshf96 m_gen;
+
+    /** Whether trim() has run since the last insertion. */
+    bool m_trimmed;
 };
 
 #include "dist_lsm_local_inl.h"
@@ -18,11 +18,14 @@
  */
 
 template <class K, class V, int Rlx>
-dist_lsm_local<K, V, Rlx>::dist_lsm_local() :
+dist_lsm_local<K, V, Rlx>::dist_lsm_local(block_recycler<K, V> *recycler) :
     m_head(nullptr),
     m_tail(nullptr),
     m_spied(nullptr),
-    m_cached_best(block<K, V>::peek_t::EMPTY())
+    m_block_storage(recycler),
+    m_item_allocator(recycler == nullptr ? nullptr : &recycler->items()),
+    m_cached_best(block<K, V>::peek_t::EMPTY()),
+    m_trimmed(true)
 {
 }
 
@@ -41,10 +44,24 @@ dist_lsm_local<K, V, Rlx>::insert(const K &key,
 {
     item<K, V> *it = m_item_allocator.acquire();
     it->initialize(key, val);
+    m_trimmed = false;
 
     insert(it, it->version(), slsm);
 }
 
+template <class K, class V, int Rlx>
+void
+dist_lsm_local<K, V, Rlx>::trim()
+{
+    if (m_trimmed) {
+        return;
+    }
+
+    m_block_storage.trim();
+    m_item_allocator.trim();
+    m_trimmed = true;
+}
+
 template <class K, class V, int Rlx>
 void
 dist_lsm_local<K, V, Rlx>::insert(item<K, V> *it,
@@ -93,13 +110,14 @@ dist_lsm_local<K, V, Rlx>::merge_insert(block<K, V> *const new_block,
         auto merged_block = m_block_storage.get_block(merged_pow2);
         merged_block->merge(insert_block, other_block);
 
-        insert_block->set_unused();
+        m_block_storage.release(insert_block);
         insert_block = merged_block;
         delete_block = other_block;
         other_block  = other_block->m_prev;
     }
 
-    if (slsm != nullptr && insert_block->size() >= (Rlx + 1) / 2) {
+    if (slsm != nullptr
+            && insert_block->size() >= (size_t)(slsm->relaxation().k() + 1) / 2) {
         /* The merged block exceeds relaxation bounds and we have a shared lsm
          * pointer, insert the new block into the shared lsm instead.
          * The shared lsm creates a copy of the passed block, and thus we can set
@@ -109,7 +127,7 @@ dist_lsm_local<K, V, Rlx>::merge_insert(block<K, V> *const new_block,
          * if we are about to merge into a block exceeding the relaxation bound.
          */
         slsm->insert(insert_block);
-        insert_block->set_unused();
+        m_block_storage.release(insert_block);
 
         if (other_block != nullptr) {
             other_block->m_next.store(nullptr, std::memory_order_relaxed);
@@ -131,7 +149,7 @@ dist_lsm_local<K, V, Rlx>::merge_insert(block<K, V> *const new_block,
     /* Remove merged blocks from the list. */
     while (delete_block != nullptr) {
         auto next_block = delete_block->m_next.load(std::memory_order_relaxed);
-        delete_block->set_unused();
+        m_block_storage.release(delete_block);
         delete_block = next_block;
     }
 }
@@ -196,7 +214,7 @@ dist_lsm_local<K, V, Rlx>::peek(typename block<K, V>::peek_t &best)
                     i->m_prev->m_next = next;
                 }
 
-                i->set_unused();
+                m_block_storage.release(i);
 
                 return;
             }
@@ -220,7 +238,7 @@ dist_lsm_local<K, V, Rlx>::peek(typename block<K, V>::peek_t &best)
                 merged_block->m_next = next->m_next.load(std::memory_order_relaxed);
                 merged_block->m_prev = new_block->m_prev;
 
-                new_block->set_unused();
+                m_block_storage.release(new_block);
                 new_block = merged_block;
             }
 
@@ -244,7 +262,7 @@ dist_lsm_local<K, V, Rlx>::peek(typename block<K, V>::peek_t &best)
 
             for (auto j = i; j != nullptr && j != next;) {
                 const auto k = j->m_next.load(std::memory_order_relaxed);
-                j->set_unused();
+                m_block_storage.release(j);
                 j = k;
             }
             i = new_block;
@@ -335,7 +353,7 @@ dist_lsm_local<K, V, Rlx>::spy(dist_lsm_local<K, V, Rlx> *victim)
     num_spied = insert_block->size();
 
     if (m_spied != nullptr) {
-        m_spied->set_unused();
+        m_block_storage.release(m_spied);
     }
     m_spied = insert_block;
 
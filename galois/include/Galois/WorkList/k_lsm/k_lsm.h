@@ -20,6 +20,7 @@
 #ifndef __K_LSM_H
 #define __K_LSM_H
 
+#include "block_recycler.h"
 #include "dist_lsm.h"
 #include "shared_lsm.h"
 #include "counters.h"
@@ -34,7 +35,9 @@ namespace kpq {
  * into the shared lsm component.
  *
  * As always, K, V and Rlx denote, respectively, the key, value classes
- * and the relaxation parameter.
+ * and the relaxation parameter. Rlx is the maximal relaxation; the relaxation
+ * in effect may be lowered (or tuned automatically) at runtime through
+ * relaxation().
  */
 
 template <class K, class V, int Rlx>
@@ -53,7 +56,15 @@ public:
     void init_thread(const size_t) const { }
     constexpr static bool supports_concurrency() { return true; }
 
+    kpq::relaxation &relaxation() { return m_shared.relaxation(); }
+
+    /** Accounts for all memory of this queue; its limit may be set at runtime. */
+    memory_budget &memory() { return m_recycler.budget(); }
+
 private:
+    /** Declared first, since both components return their memory to it
+     *  when destroyed. */
+    block_recycler<K, V>  m_recycler;
     dist_lsm<K, V, Rlx>   m_dist;
     shared_lsm<K, V, Rlx> m_shared;
 };
@@ -18,7 +18,9 @@
  */
 
 template <class K, class V, int Rlx>
-k_lsm<K, V, Rlx>::k_lsm()
+k_lsm<K, V, Rlx>::k_lsm() :
+    m_dist(&m_recycler),
+    m_shared(&m_recycler)
 {
 }
 
@@ -126,6 +128,10 @@ k_lsm<K, V, Rlx>::delete_min(K &key, V &val)
         }
     } while (m_dist.spy() > 0);
 
+    /* This thread ran out of work, let the others reuse its idle memory. */
+    m_dist.trim();
+    m_shared.trim();
+
     return false;
 }
 
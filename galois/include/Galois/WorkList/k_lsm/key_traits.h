@@ -0,0 +1,113 @@
+/*
+ *  This file is part of kpqueue.
+ *
+ *  kpqueue is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  kpqueue is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with kpqueue.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __KEY_TRAITS_H
+#define __KEY_TRAITS_H
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+namespace kpq
+{
+
+/**
+ * Describes the key domain to the block pivots, which bisect between two keys
+ * when searching for a relaxed pivot range. Any totally ordered key type
+ * (operators <, > and ==) may be used as long as key_traits provides the
+ * smallest and largest keys and a midpoint mid with lo <= mid <= hi.
+ *
+ * Integral and floating point keys are supported directly. Composite keys
+ * such as (priority, node) pairs are ordered lexicographically.
+ */
+
+template <class K, class Enable = void>
+struct key_traits
+{
+    static K min() { return std::numeric_limits<K>::lowest(); }
+    static K max() { return std::numeric_limits<K>::max(); }
+
+    static K midpoint(const K &lo, const K &hi)
+    {
+        return lo / 2 + hi / 2;
+    }
+
+    /** Whether merges may select items with arithmetic instead of branches. */
+    static constexpr bool branchless_merge = false;
+
+    /** Whether ordered_bits() is provided for the SIMD kernels in simd.h. */
+    static constexpr bool vectorizable = false;
+};
+
+template <class K>
+struct key_traits<K, typename std::enable_if<std::is_integral<K>::value>::type>
+{
+    typedef typename std::make_unsigned<K>::type U;
+
+    static K min() { return std::numeric_limits<K>::min(); }
+    static K max() { return std::numeric_limits<K>::max(); }
+
+    /** Computed on the unsigned representation so that the full range of
+     *  signed keys does not overflow. */
+    static K midpoint(const K &lo, const K &hi)
+    {
+        return lo + (K)((U)((U)hi - (U)lo) / 2);
+    }
+
+    static constexpr bool branchless_merge = (sizeof(K) == 4 || sizeof(K) == 8);
+
+    /** Maps keys onto signed 64-bit integers, preserving their order. */
+    static int64_t ordered_bits(const K &key)
+    {
+        return (std::is_signed<K>::value || sizeof(K) < 8)
+                ? (int64_t)key
+                : (int64_t)((uint64_t)key ^ (UINT64_C(1) << 63));
+    }
+
+    static constexpr bool vectorizable = sizeof(K) <= 8;
+};
+
+template <class A, class B>
+struct key_traits<std::pair<A, B>>
+{
+    typedef std::pair<A, B> K;
+
+    static K min() { return K(key_traits<A>::min(), key_traits<B>::min()); }
+    static K max() { return K(key_traits<A>::max(), key_traits<B>::max()); }
+
+    static K midpoint(const K &lo, const K &hi)
+    {
+        if (lo.first == hi.first) {
+            return K(lo.first, key_traits<B>::midpoint(lo.second, hi.second));
+        }
+
+        const A mid = key_traits<A>::midpoint(lo.first, hi.first);
+        if (mid == lo.first) {
+            /* Adjacent primary keys: split at the end of the lower one. */
+            return K(lo.first, key_traits<B>::max());
+        }
+        return K(mid, key_traits<B>::min());
+    }
+
+    static constexpr bool branchless_merge = false;
+    static constexpr bool vectorizable = false;
+};
+
+}
+
+#endif /* __KEY_TRAITS_H */
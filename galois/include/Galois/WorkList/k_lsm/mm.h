@@ -20,11 +20,109 @@
 #ifndef __MM_H
 #define __MM_H
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
 
+#include "Galois/Runtime/ll/SimpleLock.h"
+
 namespace kpq
 {
 
+/**
+ * Memory accounting for a single queue. Retained bytes are all bytes
+ * allocated and not yet freed; live bytes are those held by the thread-local
+ * components (blocks in use and attached item chunks). The difference sits
+ * idle in the shared pools. The optional limit is a soft budget: once
+ * retained memory exceeds it, components hand idle memory back eagerly
+ * instead of caching it.
+ */
+
+class memory_budget
+{
+public:
+    memory_budget() :
+        m_limit(0),
+        m_retained(0),
+        m_peak_retained(0),
+        m_live(0),
+        m_peak_live(0)
+    {
+    }
+
+    /** A limit of 0 means unlimited. */
+    void set_limit(const size_t bytes) { m_limit = bytes; }
+    size_t limit() const { return m_limit; }
+
+    bool exceeded() const
+    {
+        return m_limit != 0 && m_retained.load(std::memory_order_relaxed) > m_limit;
+    }
+
+    void retain(const ptrdiff_t bytes) { add(m_retained, m_peak_retained, bytes); }
+    void live(const ptrdiff_t bytes) { add(m_live, m_peak_live, bytes); }
+
+    size_t retained() const { return m_retained.load(std::memory_order_relaxed); }
+    size_t peak_retained() const { return m_peak_retained.load(std::memory_order_relaxed); }
+    size_t live() const { return std::max<ptrdiff_t>(m_live.load(std::memory_order_relaxed), 0); }
+    size_t peak_live() const { return std::max<ptrdiff_t>(m_peak_live.load(std::memory_order_relaxed), 0); }
+
+private:
+    static void add(std::atomic<ptrdiff_t> &value,
+                    std::atomic<ptrdiff_t> &peak,
+                    const ptrdiff_t bytes)
+    {
+        const ptrdiff_t v = value.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        ptrdiff_t p = peak.load(std::memory_order_relaxed);
+        while (v > p && !peak.compare_exchange_weak(p, v, std::memory_order_relaxed)) { }
+    }
+
+private:
+    size_t m_limit;
+    std::atomic<ptrdiff_t> m_retained;
+    std::atomic<ptrdiff_t> m_peak_retained;
+    std::atomic<ptrdiff_t> m_live;
+    std::atomic<ptrdiff_t> m_peak_live;
+};
+
+/**
+ * Batches the live byte changes of a thread-local component, which happen on
+ * nearly every operation, into occasional updates of the shared budget.
+ */
+
+class live_counter
+{
+    static constexpr ptrdiff_t BATCH = 1 << 16;
+public:
+    live_counter(memory_budget *budget) :
+        m_budget(budget),
+        m_pending(0)
+    {
+    }
+
+    ~live_counter() { flush(); }
+
+    void add(const ptrdiff_t bytes)
+    {
+        m_pending += bytes;
+        if (m_pending >= BATCH || m_pending <= -BATCH) {
+            flush();
+        }
+    }
+
+    void flush()
+    {
+        if (m_budget != nullptr && m_pending != 0) {
+            m_budget->live(m_pending);
+        }
+        m_pending = 0;
+    }
+
+private:
+    memory_budget *m_budget;
+    ptrdiff_t m_pending;
+};
+
 /**
  * The wait-free memory management scheme by Wimmer (www.pheet.org).
  */
@@ -37,11 +135,74 @@ public:
     item_allocator_item<T, BlockSize> *m_next;
 };
 
+/**
+ * Idle item chunks shared between the item allocators of a queue. Chunks are
+ * only returned once all of their items are reusable and are never freed
+ * before the pool itself, since stale block entries may still point into
+ * them; their item versions keep such entries from taking reused items.
+ */
+
+template <class T, size_t BlockSize>
+class item_chunk_pool
+{
+public:
+    typedef item_allocator_item<T, BlockSize> chunk_type;
+
+    item_chunk_pool(memory_budget *budget) :
+        m_budget(budget),
+        m_free(nullptr)
+    {
+    }
+
+    ~item_chunk_pool()
+    {
+        while (m_free != nullptr) {
+            auto next = m_free->m_next;
+            delete m_free;
+            m_free = next;
+        }
+    }
+
+    chunk_type *acquire()
+    {
+        chunk_type *chunk;
+        m_lock.lock();
+        chunk = m_free;
+        if (chunk != nullptr) {
+            m_free = chunk->m_next;
+        }
+        m_lock.unlock();
+
+        if (chunk == nullptr) {
+            chunk = new chunk_type();
+            m_budget->retain(sizeof(chunk_type));
+        }
+        m_budget->live(sizeof(chunk_type));
+        return chunk;
+    }
+
+    void release(chunk_type *chunk)
+    {
+        m_budget->live(-(ptrdiff_t)sizeof(chunk_type));
+        m_lock.lock();
+        chunk->m_next = m_free;
+        m_free = chunk;
+        m_lock.unlock();
+    }
+
+private:
+    memory_budget *m_budget;
+    Galois::Runtime::LL::SimpleLock<true> m_lock;
+    chunk_type *m_free;
+};
+
 template <class T, class ReuseCheck, size_t BlockSize = 1024>
 class item_allocator
 {
     static constexpr size_t AMORTIZATION = 1;
 public:
+    typedef item_chunk_pool<T, BlockSize> pool_type;
+
     typedef T              value_type;
     typedef T             *pointer;
     typedef const T       *const_pointer;
@@ -50,14 +211,16 @@ public:
     typedef std::size_t    size_type;
     typedef std::ptrdiff_t difference_type;
 
-    item_allocator() :
+    /** Without a pool, chunks are allocated and freed by the allocator. */
+    item_allocator(pool_type *pool = nullptr) :
+        m_pool(pool),
         m_offset(0),
         m_amortized(0),
         m_total_size(BlockSize),
         m_new_block(true),
         is_reusable()
     {
-        m_head = new item_allocator_item<T, BlockSize>();
+        m_head = new_chunk();
         m_head->m_next = m_head;
     }
 
@@ -66,10 +229,10 @@ public:
         auto next = m_head->m_next;
         while (next != m_head) {
             auto nnext = next->m_next;
-            delete next;
+            free_chunk(next);
             next = nnext;
         }
-        delete m_head;
+        free_chunk(m_head);
     }
 
     pointer acquire()
@@ -84,7 +247,7 @@ public:
             }
 
             if (m_amortized < BlockSize) {
-                auto new_block = new item_allocator_item<T, BlockSize>();
+                auto new_block = new_chunk();
                 new_block->m_next = m_head->m_next;
                 m_head->m_next = new_block;
                 m_head = new_block;
@@ -100,7 +263,49 @@ public:
         }
     }
 
+    /** Returns all chunks except the current one whose items are reusable
+     *  to the pool. Only called by the owning thread. */
+    void trim()
+    {
+        if (m_pool == nullptr) {
+            return;
+        }
+
+        auto prev = m_head;
+        auto chunk = m_head->m_next;
+        while (chunk != m_head) {
+            auto next = chunk->m_next;
+            if (std::all_of(chunk->m_items, chunk->m_items + BlockSize, is_reusable)) {
+                prev->m_next = next;
+                m_pool->release(chunk);
+                m_total_size -= BlockSize;
+            } else {
+                prev = chunk;
+            }
+            chunk = next;
+        }
+
+        m_amortized = std::min(m_amortized, m_total_size * AMORTIZATION);
+    }
+
+private:
+    item_allocator_item<T, BlockSize> *new_chunk()
+    {
+        return (m_pool == nullptr) ? new item_allocator_item<T, BlockSize>()
+                                   : m_pool->acquire();
+    }
+
+    void free_chunk(item_allocator_item<T, BlockSize> *chunk)
+    {
+        if (m_pool == nullptr) {
+            delete chunk;
+        } else {
+            m_pool->release(chunk);
+        }
+    }
+
 private:
+    pool_type *m_pool;
     item_allocator_item<T, BlockSize> *m_head;
 
     size_t m_offset;
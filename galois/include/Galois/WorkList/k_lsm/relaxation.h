@@ -0,0 +1,161 @@
+/*
+ *  This file is part of kpqueue.
+ *
+ *  kpqueue is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  kpqueue is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with kpqueue.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __RELAXATION_H
+#define __RELAXATION_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+
+#include "counters.h"
+
+namespace kpq
+{
+
+/**
+ * The current relaxation k of a k-lsm. It is read by every operation and may
+ * be changed at runtime, either explicitly through set() or by the per-thread
+ * relaxation_tuner's. The Rlx template parameter of the lsm classes only
+ * bounds the values accepted here.
+ *
+ * Lowering k does not immediately tighten existing pivot ranges; these are
+ * recalculated lazily on the next insertion into the shared lsm.
+ */
+
+class relaxation
+{
+public:
+    /** Pivot ranges are only regrown once they hold fewer than k / 2 items,
+     *  smaller values would let them run empty while items remain. */
+    static constexpr int MIN_K = 2;
+
+    relaxation(const int max_k) :
+        m_max(std::max(max_k, MIN_K)),
+        m_k(m_max),
+        m_tuning(false)
+    {
+    }
+
+    int k() const { return m_k.load(std::memory_order_relaxed); }
+    int max() const { return m_max; }
+
+    /** Sets k, clamped to [MIN_K, max()]. */
+    void set(const int k)
+    {
+        m_k.store(clamp(k), std::memory_order_relaxed);
+    }
+
+    bool tuning() const { return m_tuning.load(std::memory_order_relaxed); }
+    void set_tuning(const bool tuning)
+    {
+        m_tuning.store(tuning, std::memory_order_relaxed);
+    }
+
+    /** Replaces k by desired unless another thread changed it since
+     *  expected was read; concurrent tuners thus never compound. */
+    bool adjust(int expected, const int desired)
+    {
+        return m_k.compare_exchange_strong(expected, clamp(desired),
+                                           std::memory_order_relaxed);
+    }
+
+private:
+    int clamp(const int k) const { return std::min(std::max(k, MIN_K), m_max); }
+
+private:
+    const int m_max;
+    std::atomic<int> m_k;
+    std::atomic<bool> m_tuning;
+};
+
+/**
+ * Thread-local feedback loop driving relaxation::adjust(). Every PERIOD
+ * insertions into the shared lsm, k is doubled if more than a quarter of them
+ * had to retry their compare-and-swap of the global block array. If fewer than
+ * one in sixteen retried, contention no longer justifies the relaxation and k
+ * is halved, provided the sampled rank errors show that the relaxation is
+ * actually being used, i.e. their mean exceeds k / 4.
+ *
+ * Rank errors are measured on every RANK_SAMPLE_PERIOD-th peek as the number
+ * of items in the pivot range which are smaller than the peeked item.
+ */
+
+class relaxation_tuner
+{
+public:
+    static constexpr size_t PERIOD = 64;
+    static constexpr size_t RANK_SAMPLE_PERIOD = 16;
+
+    relaxation_tuner() :
+        m_inserts(0),
+        m_retries(0),
+        m_peeks(0),
+        m_rank_sum(0),
+        m_rank_samples(0)
+    {
+    }
+
+    void inserted(relaxation &rlx,
+                  const size_t retries)
+    {
+        m_inserts++;
+        m_retries += retries;
+        if (m_inserts < PERIOD) {
+            return;
+        }
+
+        const int k = rlx.k();
+        if (m_retries * 4 > m_inserts) {
+            if (k < rlx.max() && rlx.adjust(k, k * 2)) {
+                COUNT_INC(rlx_raises);
+            }
+        } else if (m_retries * 16 < m_inserts
+                && m_rank_samples > 0
+                && m_rank_sum * 4 > m_rank_samples * k) {
+            if (k > relaxation::MIN_K && rlx.adjust(k, k / 2)) {
+                COUNT_INC(rlx_lowers);
+            }
+        }
+
+        m_inserts = m_retries = 0;
+        m_rank_sum = m_rank_samples = 0;
+    }
+
+    /** Returns true if the rank of the current peek should be sampled. */
+    bool sample_peek()
+    {
+        return (++m_peeks % RANK_SAMPLE_PERIOD) == 0;
+    }
+
+    void rank_sampled(const size_t rank)
+    {
+        m_rank_sum += rank;
+        m_rank_samples++;
+    }
+
+private:
+    size_t m_inserts;
+    size_t m_retries;
+    size_t m_peeks;
+    size_t m_rank_sum;
+    size_t m_rank_samples;
+};
+
+}
+
+#endif /* __RELAXATION_H */
@@ -24,6 +24,7 @@
 #include "thread_local_ptr.h"
 #include "block_array.h"
 #include "block_pool.h"
+#include "relaxation.h"
 #include "shared_lsm_local.h"
 #include "versioned_array_ptr.h"
 
@@ -40,7 +41,8 @@ namespace kpq {
 template <class K, class V, int Rlx>
 class shared_lsm {
 public:
-    shared_lsm();
+    /** Blocks and items are allocated through the recycler if given. */
+    shared_lsm(block_recycler<K, V> *recycler = nullptr);
     virtual ~shared_lsm() { }
 
     void insert(const K &key);
@@ -51,10 +53,17 @@ public:
     bool delete_min(V &val);
     void find_min(typename block<K, V>::peek_t &best);
 
+    /** Returns the current thread's idle memory to the recycler. */
+    void trim();
+
     void init_thread(const size_t) const { }
     constexpr static bool supports_concurrency() { return true; }
 
+    /** The current relaxation, bounded by Rlx. */
+    kpq::relaxation &relaxation() { return m_relaxation; }
+
 private:
+    kpq::relaxation m_relaxation;
     versioned_array_ptr<K, V, Rlx> m_global_array;
     thread_local_ptr<shared_lsm_local<K, V, Rlx>> m_local_component;
 };
@@ -18,7 +18,9 @@
  */
 
 template <class K, class V, int Rlx>
-shared_lsm<K, V, Rlx>::shared_lsm()
+shared_lsm<K, V, Rlx>::shared_lsm(block_recycler<K, V> *recycler) :
+    m_relaxation(Rlx),
+    m_local_component(recycler)
 {
 }
 
@@ -35,7 +37,7 @@ shared_lsm<K, V, Rlx>::insert(const K &key,
                               const V &val)
 {
     auto local = m_local_component.get();
-    local->insert(key, val, m_global_array);
+    local->insert(key, val, m_global_array, m_relaxation);
 }
 
 template <class K, class V, int Rlx>
@@ -43,7 +45,7 @@ void
 shared_lsm<K, V, Rlx>::insert(block<K, V> *b)
 {
     auto local = m_local_component.get();
-    local->insert(b, m_global_array);
+    local->insert(b, m_global_array, m_relaxation);
 }
 
 template <class K, class V, int Rlx>
@@ -51,7 +53,7 @@ bool
 shared_lsm<K, V, Rlx>::delete_min(V &val)
 {
     auto local = m_local_component.get();
-    return local->delete_min(val, m_global_array);
+    return local->delete_min(val, m_global_array, m_relaxation);
 }
 
 template <class K, class V, int Rlx>
@@ -59,5 +61,12 @@ void
 shared_lsm<K, V, Rlx>::find_min(typename block<K, V>::peek_t &best)
 {
     auto local = m_local_component.get();
-    local->peek(best, m_global_array);
+    local->peek(best, m_global_array, m_relaxation);
+}
+
+template <class K, class V, int Rlx>
+void
+shared_lsm<K, V, Rlx>::trim()
+{
+    m_local_component.get()->trim();
 }
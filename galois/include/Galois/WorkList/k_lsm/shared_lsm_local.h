@@ -25,6 +25,8 @@
 #include "mm.h"
 #include "block_array.h"
 #include "block_pool.h"
+#include "block_recycler.h"
+#include "relaxation.h"
 #include "versioned_array_ptr.h"
 
 namespace kpq {
@@ -34,25 +36,34 @@ class shared_lsm_local {
     template <class X, class Y, int Z>
     friend class shared_lsm;
 public:
-    shared_lsm_local();
+    shared_lsm_local(block_recycler<K, V> *recycler = nullptr);
     virtual ~shared_lsm_local() { }
 
     void insert(const K &key,
                 const V &val,
-                versioned_array_ptr<K, V, Rlx> &global_array);
+                versioned_array_ptr<K, V, Rlx> &global_array,
+                relaxation &rlx);
     void insert(block<K, V> *b,
-                versioned_array_ptr<K, V, Rlx> &global_array);
+                versioned_array_ptr<K, V, Rlx> &global_array,
+                relaxation &rlx);
 
     bool delete_min(V &val,
-                    versioned_array_ptr<K, V, Rlx> &global_array);
+                    versioned_array_ptr<K, V, Rlx> &global_array,
+                    relaxation &rlx);
     void peek(typename block<K, V>::peek_t &best,
-              versioned_array_ptr<K, V, Rlx> &global_array);
+              versioned_array_ptr<K, V, Rlx> &global_array,
+              relaxation &rlx);
+
+    /** Returns idle blocks and item chunks to the recycler. Cheap if nothing
+     *  has been inserted since the last call. */
+    void trim();
 
 private:
     /** The internal function responsible for actual insertion. The given
      *  block must have been allocated by the shared lsm. */
     void insert_block(block<K, V> *b,
-                      versioned_array_ptr<K, V, Rlx> &global_array);
+                      versioned_array_ptr<K, V, Rlx> &global_array,
+                      relaxation &rlx);
 
     /** Refreshes the local array copy and ensures that it is both up to date
      *  and consistent. observed_packed and observed_version are set to the
@@ -68,6 +79,14 @@ private:
      *  return it. */
     typename block<K, V>::peek_t m_cached_best;
 
+    /** Collects this thread's contention and rank error observations. */
+    relaxation_tuner m_tuner;
+
+    /** Whether trim() has run since the last insertion. */
+    bool m_trimmed;
+
+    block_recycler<K, V> *m_recycler;
+
     /* ---- Item memory management. ---- */
 
     item_allocator<item<K, V>, typename item<K, V>::reuse> m_item_pool;
@@ -18,17 +18,35 @@
  */
 
 template <class K, class V, int Rlx>
-shared_lsm_local<K, V, Rlx>::shared_lsm_local() :
-    m_cached_best(block<K, V>::peek_t::EMPTY())
+shared_lsm_local<K, V, Rlx>::shared_lsm_local(block_recycler<K, V> *recycler) :
+    m_cached_best(block<K, V>::peek_t::EMPTY()),
+    m_trimmed(true),
+    m_recycler(recycler),
+    m_item_pool(recycler == nullptr ? nullptr : &recycler->items()),
+    m_block_pool(recycler)
 {
 }
 
+template <class K, class V, int Rlx>
+void
+shared_lsm_local<K, V, Rlx>::trim()
+{
+    if (m_trimmed) {
+        return;
+    }
+
+    m_block_pool.trim();
+    m_item_pool.trim();
+    m_trimmed = true;
+}
+
 template <class K, class V, int Rlx>
 void
 shared_lsm_local<K, V, Rlx>::insert(
         const K &key,
         const V &val,
-        versioned_array_ptr<K, V, Rlx> &global_array)
+        versioned_array_ptr<K, V, Rlx> &global_array,
+        relaxation &rlx)
 {
     auto i = m_item_pool.acquire();
     i->initialize(key, val);
@@ -38,32 +56,36 @@ shared_lsm_local<K, V, Rlx>::insert(
     auto b = m_block_pool.get_block(1);
     b->insert(i, i->version());
 
-    insert_block(b, global_array);
+    insert_block(b, global_array, rlx);
 }
 
 template <class K, class V, int Rlx>
 void
 shared_lsm_local<K, V, Rlx>::insert(
         block<K, V> *b,
-        versioned_array_ptr<K, V, Rlx> &global_array)
+        versioned_array_ptr<K, V, Rlx> &global_array,
+        relaxation &rlx)
 {
     assert(!m_block_pool.contains(b)), "Not called with a dist lsm block";
 
     auto c = m_block_pool.get_block(b->power_of_2());
     c->copy(b);
 
-    insert_block(c, global_array);
+    insert_block(c, global_array, rlx);
 }
 
 template <class K, class V, int Rlx>
 void
 shared_lsm_local<K, V, Rlx>::insert_block(
         block<K, V> *b,
-        versioned_array_ptr<K, V, Rlx> &global_array)
+        versioned_array_ptr<K, V, Rlx> &global_array,
+        relaxation &rlx)
 {
     assert(m_block_pool.contains(b)), "Given block not allocated by shared lsm";
     COUNT_INC(slsm_inserts);
 
+    const int k = rlx.k();
+    size_t retries = 0;
     while (true) {
         /* Fetch a consistent copy of the global array. */
 
@@ -79,7 +101,7 @@ shared_lsm_local<K, V, Rlx>::insert_block(
         auto new_blocks_ptr = new_blocks.ptr();
         new_blocks_ptr->copy_from(&m_local_array_copy);
         new_blocks_ptr->increment_version();
-        new_blocks_ptr->insert(b, &m_block_pool);
+        new_blocks_ptr->insert(b, &m_block_pool, k);
 
         /* Try to update the global array. */
 
@@ -94,18 +116,30 @@ shared_lsm_local<K, V, Rlx>::insert_block(
         }
 
         COUNT_INC(slsm_insert_retries);
+        retries++;
         m_block_pool.free_local_except(b);
     }
+
+    if (rlx.tuning()) {
+        m_tuner.inserted(rlx, retries);
+    }
+
+    /* Over budget, hand superseded blocks to other threads right away. */
+    m_trimmed = false;
+    if (m_recycler != nullptr && m_recycler->budget().exceeded()) {
+        m_block_pool.trim();
+    }
 }
 
 template <class K, class V, int Rlx>
 bool
 shared_lsm_local<K, V, Rlx>::delete_min(
         V &val,
-        versioned_array_ptr<K, V, Rlx> &global_array)
+        versioned_array_ptr<K, V, Rlx> &global_array,
+        relaxation &rlx)
 {
     typename block<K, V>::peek_t best = block<K, V>::peek_t::EMPTY();
-    peek(best, global_array);
+    peek(best, global_array, rlx);
 
     if (best.m_item == nullptr) {
         return false;  /* We did our best, give up. */
@@ -117,7 +151,8 @@ shared_lsm_local<K, V, Rlx>::delete_min(
 template <class K, class V, int Rlx>
 void
 shared_lsm_local<K, V, Rlx>::peek(typename block<K, V>::peek_t &best,
-                                  versioned_array_ptr<K, V, Rlx> &global_array)
+                                  versioned_array_ptr<K, V, Rlx> &global_array,
+                                  relaxation &rlx)
 {
     if (local_array_copy_is_fresh(global_array)
             && !m_cached_best.empty()
@@ -130,12 +165,18 @@ shared_lsm_local<K, V, Rlx>::peek(typename block<K, V>::peek_t &best,
     block_array<K, V, Rlx> *observed_packed;
     version_t observed_version;
 
+    const int k = rlx.k();
+
     COUNT_INC(slsm_peeks_performed);
     do {
         refresh_local_array_copy(observed_packed, observed_version, global_array);
-        best = m_cached_best = m_local_array_copy.peek();
+        best = m_cached_best = m_local_array_copy.peek(k);
         COUNT_INC(slsm_peek_attempts);
     } while (global_array.version() != observed_version);
+
+    if (rlx.tuning() && !best.empty() && m_tuner.sample_peek()) {
+        m_tuner.rank_sampled(m_local_array_copy.rank_of(best));
+    }
 }
 
 template <class K, class V, int Rlx>
@@ -0,0 +1,299 @@
+/*
+ *  This file is part of kpqueue.
+ *
+ *  kpqueue is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  kpqueue is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with kpqueue.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __SIMD_H
+#define __SIMD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#include "key_traits.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define KPQ_HAVE_AVX2_KERNELS 1
+#include <immintrin.h>
+#define KPQ_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace kpq
+{
+
+/**
+ * Vectorized kernels for merging blocks and searching pivots. Items are
+ * block_item's, i.e. structs holding an m_key member; their keys must have
+ * a key_traits<K>::ordered_bits() mapping onto signed 64-bit integers.
+ *
+ * The kernels are compiled for AVX2 regardless of the global compiler flags
+ * and are only used if the CPU supports it, which is checked once at runtime.
+ * Setting KPQ_NO_SIMD in the environment forces the scalar code paths.
+ */
+
+namespace simd
+{
+
+/** Merges whose inputs both contain at least this many items are vectorized. */
+static constexpr size_t MERGE_THRESHOLD = 32;
+
+/** upper_bound() narrows its range by binary search until it is this small. */
+static constexpr size_t SEARCH_WINDOW = 16;
+
+inline bool
+use_avx2()
+{
+#ifdef KPQ_HAVE_AVX2_KERNELS
+    static const bool enabled = __builtin_cpu_supports("avx2")
+            && getenv("KPQ_NO_SIMD") == nullptr;
+    return enabled;
+#else
+    return false;
+#endif
+}
+
+#ifdef KPQ_HAVE_AVX2_KERNELS
+
+template <class Item>
+KPQ_TARGET_AVX2 inline __m256i
+load_keys(const Item *it)
+{
+    typedef key_traits<decltype(it->m_key)> traits;
+    return _mm256_set_epi64x(traits::ordered_bits(it[3].m_key),
+                             traits::ordered_bits(it[2].m_key),
+                             traits::ordered_bits(it[1].m_key),
+                             traits::ordered_bits(it[0].m_key));
+}
+
+/** Addresses of it[0..3], which are carried along with their keys. */
+template <class Item>
+KPQ_TARGET_AVX2 inline __m256i
+load_ptrs(const Item *it)
+{
+    return _mm256_add_epi64(_mm256_set1_epi64x((int64_t)it),
+                            _mm256_set_epi64x(3 * sizeof(Item), 2 * sizeof(Item),
+                                              sizeof(Item), 0));
+}
+
+/** One compare-exchange stage within a vector: lanes selected by MinLanes
+ *  (a _mm256_blend_epi32 mask) receive the minimum of themselves and their
+ *  partner in the permutation Perm, the remaining lanes the maximum. */
+template <int Perm, int MinLanes>
+KPQ_TARGET_AVX2 inline void
+bitonic_stage(__m256i &k, __m256i &p)
+{
+    const __m256i k2 = _mm256_permute4x64_epi64(k, Perm);
+    const __m256i p2 = _mm256_permute4x64_epi64(p, Perm);
+    const __m256i swap = _mm256_blend_epi32(_mm256_cmpgt_epi64(k2, k),
+                                            _mm256_cmpgt_epi64(k, k2),
+                                            MinLanes);
+    k = _mm256_blendv_epi8(k, k2, swap);
+    p = _mm256_blendv_epi8(p, p2, swap);
+}
+
+/** Bitonic merge of two sorted vectors: on return, (ka, pa) holds the four
+ *  smallest and (kb, pb) the four largest keys, both sorted ascending. */
+KPQ_TARGET_AVX2 inline void
+bitonic_merge4(__m256i &ka, __m256i &pa, __m256i &kb, __m256i &pb)
+{
+    kb = _mm256_permute4x64_epi64(kb, 0x1b);
+    pb = _mm256_permute4x64_epi64(pb, 0x1b);
+
+    const __m256i gt = _mm256_cmpgt_epi64(ka, kb);
+    const __m256i klo = _mm256_blendv_epi8(ka, kb, gt);
+    const __m256i plo = _mm256_blendv_epi8(pa, pb, gt);
+    kb = _mm256_blendv_epi8(kb, ka, gt);
+    pb = _mm256_blendv_epi8(pb, pa, gt);
+    ka = klo;
+    pa = plo;
+
+    bitonic_stage<0x4e, 0x0f>(ka, pa);
+    bitonic_stage<0xb1, 0x33>(ka, pa);
+    bitonic_stage<0x4e, 0x0f>(kb, pb);
+    bitonic_stage<0xb1, 0x33>(kb, pb);
+}
+
+template <class Item>
+inline Item *
+merge_tail(const Item *l, const Item *lend,
+           const Item *r, const Item *rend,
+           Item *dst)
+{
+    while (l < lend && r < rend) {
+        *dst++ = (l->m_key < r->m_key) ? *l++ : *r++;
+    }
+
+    while (l < lend) *dst++ = *l++;
+    while (r < rend) *dst++ = *r++;
+
+    return dst;
+}
+
+/**
+ * Merges the sorted ranges [l, lend) and [r, rend), which must both contain
+ * at least four items, into dst and returns the end of the merged range.
+ * Four items are emitted per step by a bitonic network; the next four inputs
+ * are taken from whichever range has the smaller head. Unlike the scalar
+ * merge, the order of equal keys is unspecified.
+ */
+template <class Item>
+KPQ_TARGET_AVX2 Item *
+merge(const Item *l, const Item *lend,
+      const Item *r, const Item *rend,
+      Item *dst)
+{
+    __m256i ka = load_keys(l), pa = load_ptrs(l);
+    __m256i kb = load_keys(r), pb = load_ptrs(r);
+    l += 4;
+    r += 4;
+
+    alignas(32) int64_t out[4];
+    while (true) {
+        bitonic_merge4(ka, pa, kb, pb);
+
+        _mm256_store_si256((__m256i *)out, pa);
+        for (int i = 0; i < 4; i++) {
+            *dst++ = *(const Item *)out[i];
+        }
+
+        ka = kb;
+        pa = pb;
+
+        const Item **next;
+        const Item *next_end;
+        if (l < lend && (r == rend || !(r->m_key < l->m_key))) {
+            next = &l;
+            next_end = lend;
+        } else {
+            next = &r;
+            next_end = rend;
+        }
+
+        if (next_end - *next < 4) {
+            break;
+        }
+
+        kb = load_keys(*next);
+        pb = load_ptrs(*next);
+        *next += 4;
+    }
+
+    /* All emitted items are smaller than the four carried ones and than
+     * everything remaining. Merge the carry with the short remainder first,
+     * then the result with the other one. */
+
+    Item carry[4];
+    _mm256_store_si256((__m256i *)out, pa);
+    for (int i = 0; i < 4; i++) {
+        carry[i] = *(const Item *)out[i];
+    }
+
+    Item merged[4 + 3];
+    if (lend - l < 4) {
+        const Item *merged_end = merge_tail(carry, carry + 4, l, lend, merged);
+        return merge_tail((const Item *)merged, merged_end, r, rend, dst);
+    } else {
+        const Item *merged_end = merge_tail(carry, carry + 4, r, rend, merged);
+        return merge_tail((const Item *)merged, merged_end, l, lend, dst);
+    }
+}
+
+/** Counts the keys in items[0, n) which are smaller than or equal to key. */
+template <class Item, class K>
+KPQ_TARGET_AVX2 size_t
+count_not_greater(const Item *items,
+                  const size_t n,
+                  const K &key)
+{
+    const __m256i k = _mm256_set1_epi64x(key_traits<K>::ordered_bits(key));
+
+    size_t count = 0, i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m256i gt = _mm256_cmpgt_epi64(load_keys(items + i), k);
+        const int mask = _mm256_movemask_pd(_mm256_castsi256_pd(gt));
+        count += 4 - __builtin_popcount(mask);
+        if (mask != 0) {
+            return count;
+        }
+    }
+    for (; i < n && !(items[i].m_key > key); i++) {
+        count++;
+    }
+    return count;
+}
+
+#endif /* KPQ_HAVE_AVX2_KERNELS */
+
+/** Counts the keys in items[0, n) which are smaller than or equal to key. */
+template <class Item, class K>
+size_t
+count_not_greater(const Item *items,
+                  const size_t n,
+                  const K &key,
+                  std::false_type)
+{
+    size_t count = 0;
+    while (count < n && !(items[count].m_key > key)) {
+        count++;
+    }
+    return count;
+}
+
+template <class Item, class K>
+size_t
+count_not_greater(const Item *items,
+                  const size_t n,
+                  const K &key,
+                  std::true_type)
+{
+#ifdef KPQ_HAVE_AVX2_KERNELS
+    if (use_avx2()) {
+        return count_not_greater(items, n, key);
+    }
+#endif
+    return count_not_greater(items, n, key, std::false_type());
+}
+
+/**
+ * Returns the index of the first item in [first, last) whose key is greater
+ * than the given key, or last if there is none. Keys in the range must be
+ * sorted, which holds for all items of a block regardless of whether they
+ * have been taken since. The range is narrowed by binary search, and the
+ * remaining window is scanned (with SIMD compares if the key allows it).
+ */
+template <class Item, class K>
+size_t
+upper_bound(const Item *items,
+            size_t first,
+            size_t last,
+            const K &key)
+{
+    while (last - first > SEARCH_WINDOW) {
+        const size_t mid = first + (last - first) / 2;
+        if (items[mid].m_key > key) {
+            last = mid;
+        } else {
+            first = mid + 1;
+        }
+    }
+    return first + count_not_greater(items + first, last - first, key,
+            std::integral_constant<bool, key_traits<K>::vectorizable>());
+}
+
+}
+
+}
+
+#endif /* __SIMD_H */
@@ -22,6 +22,7 @@
 
 #include <atomic>
 #include <cstddef>
+#include <utility>
 
 #include "Galois/Runtime/PerThreadStorage.h"
 
@@ -37,6 +38,13 @@ template <class T>
 class thread_local_ptr
 {
 public:
+    /** Each thread's element is constructed from the given arguments. */
+    template <class... Args>
+    thread_local_ptr(Args&&... args) :
+        m_items(std::forward<Args>(args)...)
+    {
+    }
+
     T *get()
     {
         return m_items.getLocal();
@@ -8,6 +8,6 @@ rm corun.txt
 
 for g in scalefree/rmat16p-2e27.gr scalefree/rmat16p-2e24.gr # road/USA-road-d.USA.gr road/USA-road-t.USA.gr ljournal-2008.gr twitter40.gr random/r4-2e24.gr planar10M.bin scalefree/rmat-large.gr road/USA-road-d.USA.gr road/USA-road-t.USA.gr # clique4000.bin
 do
-  env OBIM_PRIO_STATS= ./run.py -m libc -t 1 -r 1 -g "inputs/${g}" -v obim -D 0 -d graph-metrics sssp bfs
+  env OBIM_PRIO_STATS= ./sched-bench.py -t 1 -r 1 -g "inputs/${g}" -s obim -D 0 -l graph-metrics -o "graph-metrics/$(basename ${g} .gr).csv" sssp bfs
 done
 
@@ -0,0 +1,177 @@
+#!/usr/bin/python
+"""
+Runs every app with every priority scheduler and thread count and collects
+the results into one CSV on stdout (or the file given by -o).
+
+Usage: python sched-bench.py -g graph [-options] [apps...]
+
+Options:
+  -a ..., --apps=...        directory holding the built apps (default: _gate_build/apps)
+  -g ..., --graph=...       input graph
+  -T ..., --transpose=...   transpose of the input graph (default: graph.transpose)
+  -s ..., --schedulers=...  comma separated -wl names (default: all the app accepts)
+  -t ..., --threads=...     comma separated thread counts (default: 1)
+  -r ..., --runs=...        runs per configuration (default: 1)
+  -D ..., --delta=...       delta shift for sssp (default: 8)
+  -m ..., --malloc=...      library to LD_PRELOAD
+  -n, --numa                NUMA run (don't fake single board topology)
+  -o ..., --output=...      CSV file to write
+  -l ..., --logs=...        directory to keep the output of each run in
+
+Columns: app, graph, scheduler, threads, delta, run, status, wall time in
+seconds, the Time statistic and the sum over all loops of the Iterations,
+BadWork and nEmptyPop statistics. Schedulers are discovered by passing an
+unknown name to -wl, which makes the app list the names it accepts.
+"""
+from __future__ import print_function
+import sys, getopt, os, subprocess, shlex, time
+
+def usage(val):
+  print(__doc__)
+  sys.exit(val)
+
+# app: [ command line, timeout in seconds ]
+benchmarks = {
+  "sssp" : [ "sssp/sssp -noverify -t %(threads)d -delta %(delta)d -wl %(wl)s -startNode %(node)d %(graph)s", 300 ],
+  "bfs" : [ "bfs/bfs -noverify -t %(threads)d -algo async -wl %(wl)s -startNode %(node)d %(graph)s", 300 ],
+  "pagerank" : [ "pagerank/pagerank -t %(threads)d -wl %(wl)s -algo async_prt -graphTranspose %(transpose)s -amp 100 -tolerance 0.001 %(graph)s", 300 ],
+  "boruvkamerge" : [ "boruvka/boruvka-merge -noverify -t %(threads)d -wl %(wl)s %(graph)s", 120 ],
+  "betcet" : [ "betweennesscentrality/betweennesscentrality-inner -noverify -t %(threads)d -wl %(wl)s %(graph)s", 120 ],
+}
+
+STATS = [ "Iterations", "BadWork", "nEmptyPop" ]
+
+def start_node(graph):
+  if "rmat-large.gr" in graph: return 1
+  if "twitter40.gr" in graph: return 12
+  return 0
+
+def execute(cmd, env, timeout):
+  """Returns (status, wall seconds, output)."""
+  start = time.time()
+  proc = subprocess.Popen(shlex.split(cmd), env=env, stdout=subprocess.PIPE,
+                          stderr=subprocess.STDOUT, universal_newlines=True)
+  try:
+    out, _ = proc.communicate(timeout=timeout)
+  except TypeError:
+    # python 2 has no timeout
+    out, _ = proc.communicate()
+  except subprocess.TimeoutExpired:
+    proc.kill()
+    out, _ = proc.communicate()
+    return "timeout", time.time() - start, out
+  elapsed = time.time() - start
+  if proc.returncode != 0:
+    return "exit%d" % (proc.returncode), elapsed, out
+  return "ok", elapsed, out
+
+def parse_stats(out):
+  """Sums the STAT,loop,category,threads,total,... lines over all loops."""
+  stats = {}
+  for ln in out.splitlines():
+    f = ln.split(",")
+    if len(f) < 5 or f[0] != "STAT":
+      continue
+    try:
+      stats[f[2]] = stats.get(f[2], 0) + float(f[4])
+    except ValueError:
+      pass
+  return stats
+
+def schedulers_of(cmd, env):
+  """The -wl names an app accepts, as listed when given an unknown one."""
+  status, elapsed, out = execute(cmd, env, 600)
+  for ln in out.splitlines():
+    if "Choose one of:" in ln:
+      return ln.split("Choose one of:")[1].split()
+  return []
+
+def main(argv):
+  try:
+    opts, args = getopt.getopt(argv, "a:g:T:s:t:r:D:m:no:l:",
+        [ "apps=", "graph=", "transpose=", "schedulers=", "threads=", "runs=",
+          "delta=", "malloc=", "numa", "output=", "logs=" ])
+  except getopt.GetoptError:
+    usage(1)
+
+  appdir = "_gate_build/apps"
+  graph = None
+  transpose = None
+  schedulers = None
+  threads = [ 1 ]
+  runs = 1
+  delta = 8
+  output = None
+  logs = None
+  env = dict(os.environ)
+  for opt, arg in opts:
+    if opt in ("-a", "--apps"): appdir = arg
+    elif opt in ("-g", "--graph"): graph = arg
+    elif opt in ("-T", "--transpose"): transpose = arg
+    elif opt in ("-s", "--schedulers"): schedulers = arg.split(",")
+    elif opt in ("-t", "--threads"): threads = [ int(t) for t in arg.split(",") ]
+    elif opt in ("-r", "--runs"): runs = int(arg)
+    elif opt in ("-D", "--delta"): delta = int(arg)
+    elif opt in ("-m", "--malloc"): env["LD_PRELOAD"] = arg
+    elif opt in ("-n", "--numa"): env["GALOIS_DONT_FAKE_TOPO"] = ""
+    elif opt in ("-o", "--output"): output = arg
+    elif opt in ("-l", "--logs"): logs = arg
+
+  if not graph:
+    usage(1)
+  if transpose is None:
+    transpose = graph + ".transpose"
+
+  apps = args
+  if len(apps) == 0:
+    apps = sorted(benchmarks.keys())
+  for app in apps:
+    if app not in benchmarks:
+      print("unknown app %s" % (app), file=sys.stderr)
+      usage(1)
+
+  if logs and not os.path.isdir(logs):
+    os.makedirs(logs)
+
+  f = open(output, "w") if output else sys.stdout
+  # csv.py next to this script shadows the csv module
+  def writerow(row):
+    f.write(",".join([ str(v) for v in row ]) + "\n")
+    f.flush()
+
+  writerow([ "app", "graph", "scheduler", "threads", "delta", "run", "status",
+            "wall", "time" ] + STATS)
+
+  gname = os.path.splitext(os.path.basename(graph))[0]
+  for app in apps:
+    cmdline, timeout = benchmarks[app]
+    params = { "graph": graph, "transpose": transpose, "delta": delta,
+               "node": start_node(graph), "threads": 1, "wl": "?" }
+    sched = schedulers
+    if sched is None:
+      sched = schedulers_of(os.path.join(appdir, cmdline % params), env)
+      if not sched:
+        print("%s lists no schedulers, skipping" % (app), file=sys.stderr)
+        continue
+
+    for wl in sched:
+      for t in threads:
+        params["threads"] = t
+        params["wl"] = wl
+        cmd = os.path.join(appdir, cmdline % params)
+        for r in range(runs):
+          print("%s %s %s %d threads run %d" % (time.strftime("%H:%M:%S"), app, wl, t, r), file=sys.stderr)
+          status, elapsed, out = execute(cmd, env, timeout)
+          if logs:
+            with open(os.path.join(logs, "%s-%s.%s.d%d_%d_%d.txt" % (app, wl, gname, delta, t, r)), "w") as log:
+              log.write("==== %s\n" % (cmd))
+              log.write(out)
+          if "No work list!" in out:
+            status = "noworklist"
+          stats = parse_stats(out)
+          writerow([ app, gname, wl, t, delta, r, status, "%.3f" % (elapsed),
+                "%d" % (stats.get("Time", 0)) ]
+              + [ "%d" % (stats.get(s, 0)) for s in STATS ])
+
+if __name__ == "__main__":
+  main(sys.argv[1:])
@@ -31,11 +31,15 @@
 #include "Galois/Runtime/ActiveThreads.h"
 #include "Galois/Runtime/Support.h"
 #include "Galois/Runtime/ll/CompilerSpecific.h"
+#include "Galois/Runtime/ll/gio.h"
 #include "Galois/Timer.h"
 #include <pthread.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cstdlib>
 #include <cstdio>
+#include <vector>
 
 class PthreadBarrier: public Galois::Runtime::Barrier {
   pthread_barrier_t bar;
@@ -256,14 +260,202 @@ public:
   }
 };
 
+/**
+ * Two level barrier. Threads of a package synchronize by dissemination:
+ * in round k, the thread of rank r signals rank (r + 2^k) mod m and waits
+ * for the signal of rank (r - 2^k) mod m. After the last round, the
+ * package leader (rank 0) knows its whole package has arrived. Leaders
+ * then combine arrivals up a 4-ary tree over packages, and releases come
+ * back down it. The rest of a package only spins on its own package node.
+ *
+ * Flags hold the episode they were last signaled for instead of a sense,
+ * so they never need to be reset. Values passed to reduce are combined by
+ * the leaders on the way up and the result is published by the root
+ * before releasing.
+ *
+ * Unlike the other barriers, reinit may be called as soon as the calling
+ * thread has left the barrier: it waits for the threads that were
+ * released but have not noticed yet.
+ */
+class HierBarrier : public Galois::Runtime::Barrier {
+  static const unsigned MaxRounds = 16;
+
+  struct pkgnode {
+    std::atomic<unsigned> arrived;
+    std::atomic<unsigned> released;
+    uint64_t value;
+    pkgnode* children[4];
+    unsigned numChildren;
+
+    pkgnode(): arrived(0), released(0), value(0), numChildren(0) { }
+  };
+
+  struct threadnode {
+    std::atomic<unsigned> flags[MaxRounds];
+    threadnode* partners[MaxRounds];
+    unsigned rounds;
+    unsigned episode;
+    uint64_t value;
+    pkgnode* pkg;
+    std::atomic<bool> inside;
+    //! Threads whose values this package leader combines; empty otherwise
+    std::vector<threadnode*> members;
+
+    threadnode(): rounds(0), episode(0), value(0), pkg(0), inside(false) { }
+  };
+
+  Galois::Runtime::PerPackageStorage<pkgnode> pkgs;
+  Galois::Runtime::PerThreadStorage<threadnode> nodes;
+  Galois::Runtime::PerThreadStorage<Galois::Timer> barrierTime;
+  uint64_t result;
+
+  static bool reached(const std::atomic<unsigned>& flag, unsigned episode) {
+    return (int) (flag.load(std::memory_order_acquire) - episode) >= 0;
+  }
+
+  static void spinUntil(const std::atomic<unsigned>& flag, unsigned episode) {
+    while (!reached(flag, episode))
+      Galois::Runtime::LL::asmPause();
+  }
+
+  static uint64_t combine(uint64_t a, uint64_t b, ReduceOp op) {
+    switch (op) {
+      case MIN: return std::min(a, b);
+      case MAX: return std::max(a, b);
+      default: return a + b;
+    }
+  }
+
+  void _reinit(unsigned P) {
+    for (unsigned i = 0; i < nodes.size(); ++i)
+      while (nodes.getRemote(i)->inside.load(std::memory_order_acquire))
+        Galois::Runtime::LL::asmPause();
+
+    unsigned numPkgs = Galois::Runtime::LL::getMaxPackageForThread(P-1) + 1;
+    std::vector<std::vector<unsigned> > byPkg(numPkgs);
+    for (unsigned i = 0; i < P; ++i)
+      byPkg[Galois::Runtime::LL::getPackageForThread(i)].push_back(i);
+
+    for (unsigned i = 0; i < numPkgs; ++i) {
+      pkgnode& p = *pkgs.getRemoteByPkg(i);
+      p.arrived = 0;
+      p.released = 0;
+      p.numChildren = 0;
+      for (unsigned j = 4*i+1; j <= 4*i+4 && j < numPkgs; ++j)
+        p.children[p.numChildren++] = pkgs.getRemoteByPkg(j);
+
+      std::vector<unsigned>& tids = byPkg[i];
+      unsigned m = tids.size();
+      for (unsigned r = 0; r < m; ++r) {
+        threadnode& n = *nodes.getRemote(tids[r]);
+        n.rounds = 0;
+        for (unsigned d = 1; d < m; d *= 2) {
+          if (n.rounds == MaxRounds)
+            GALOIS_DIE("too many threads in package");
+          n.flags[n.rounds] = 0;
+          n.partners[n.rounds++] = nodes.getRemote(tids[(r + d) % m]);
+        }
+        n.episode = 0;
+        n.pkg = &p;
+        n.members.clear();
+        if (r == 0)
+          for (unsigned k = 0; k < m; ++k)
+            n.members.push_back(nodes.getRemote(tids[k]));
+      }
+    }
+    result = 0;
+  }
+
+  uint64_t arrive(uint64_t val, ReduceOp op) {
+    threadnode& n = *nodes.getLocal();
+    pkgnode& p = *n.pkg;
+    unsigned e = ++n.episode;
+    n.value = val;
+    n.inside.store(true, std::memory_order_relaxed);
+
+    for (unsigned k = 0; k < n.rounds; ++k) {
+      n.partners[k]->flags[k].store(e, std::memory_order_release);
+      spinUntil(n.flags[k], e);
+    }
+
+    if (!n.members.empty()) {
+      uint64_t v = n.members[0]->value;
+      for (unsigned k = 1; k < n.members.size(); ++k)
+        v = combine(v, n.members[k]->value, op);
+      for (unsigned k = 0; k < p.numChildren; ++k) {
+        spinUntil(p.children[k]->arrived, e);
+        v = combine(v, p.children[k]->value, op);
+      }
+      p.value = v;
+      if (&p == pkgs.getRemoteByPkg(0)) {
+        result = v;
+        p.released.store(e, std::memory_order_release);
+      } else {
+        p.arrived.store(e, std::memory_order_release);
+        spinUntil(p.released, e);
+      }
+      for (unsigned k = 0; k < p.numChildren; ++k)
+        p.children[k]->released.store(e, std::memory_order_release);
+    } else {
+      spinUntil(p.released, e);
+    }
+    uint64_t r = result;
+    n.inside.store(false, std::memory_order_release);
+    return r;
+  }
+
+public:
+  HierBarrier(unsigned val = Galois::Runtime::activeThreads) {
+    _reinit(val);
+  }
+
+  virtual void reinit(unsigned val) {
+    _reinit(val);
+  }
+
+  virtual void wait() {
+    arrive(0, SUM);
+  }
+
+  virtual uint64_t reduce(uint64_t val, ReduceOp op) {
+    return arrive(val, op);
+  }
+
+  void before(void) {
+    barrierTime.getLocal()->start();
+  }
+
+  void after(const char* loopname) {
+    barrierTime.getLocal()->stop();
+    Galois::Runtime::reportStat(loopname, "BarrierTime", barrierTime.getLocal()->get());
+  }
+};
+
 Galois::Runtime::Barrier::~Barrier() {}
 
+uint64_t Galois::Runtime::Barrier::reduce(uint64_t val, ReduceOp op) {
+  GALOIS_DIE("barrier does not support reductions");
+  return val;
+}
+
 Galois::Runtime::Barrier* Galois::Runtime::createSimpleBarrier() {
   return new PthreadBarrier();
 }
 
+Galois::Runtime::Barrier* Galois::Runtime::createMCSBarrier() {
+  return new MCSBarrier();
+}
+
+Galois::Runtime::Barrier* Galois::Runtime::createTopoBarrier() {
+  return new TopoBarrier();
+}
+
+Galois::Runtime::Barrier* Galois::Runtime::createHierBarrier() {
+  return new HierBarrier();
+}
+
 Galois::Runtime::Barrier& Galois::Runtime::getSystemBarrier() {
-  static TopoBarrier b;
+  static HierBarrier b;
   static unsigned num = ~0;
   if (activeThreads != num) {
     num = activeThreads;
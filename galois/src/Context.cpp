@@ -27,6 +27,9 @@
 #include "Galois/Runtime/ll/SimpleLock.h"
 #include "Galois/Runtime/ll/CacheLineStorage.h"
 
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
 #include <stdio.h>
 
 #ifdef GALOIS_USE_LONGJMP
@@ -86,6 +89,10 @@ void Galois::Runtime::doCheckWrite() {
     throw Galois::Runtime::REACHED_FAILSAFE;
 #endif
   }
+#if !defined(GALOIS_USE_SEQ_ONLY)
+  if (thread_ctx)
+    thread_ctx->reachFailsafe();
+#endif
 }
 
 void Galois::Runtime::setThreadContext(Galois::Runtime::SimpleRuntimeContext* ctx) {
@@ -96,7 +103,46 @@ Galois::Runtime::SimpleRuntimeContext* Galois::Runtime::getThreadContext() {
   return thread_ctx;
 }
 
+static __thread Galois::Runtime::Lockable* lastConflict = 0;
+
+namespace {
+
+struct HotSlot {
+  std::atomic<unsigned> window;
+  std::atomic<unsigned> count;
+};
+
+const unsigned HotSlotsLog2 = 12;
+HotSlot hotSlots[1 << HotSlotsLog2];
+
+unsigned hashLockable(Galois::Runtime::Lockable* lockable) {
+  return (reinterpret_cast<uintptr_t>(lockable) * 0x9E3779B97F4A7C15ull) >> (64 - HotSlotsLog2);
+}
+
+}
+
+Galois::Runtime::Lockable* Galois::Runtime::getLastConflict() {
+  return lastConflict;
+}
+
+unsigned Galois::Runtime::recordConflictHotness(Lockable* lockable) {
+  // Counts restart every millisecond; the races in doing so only lose counts
+  unsigned now = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  HotSlot& s = hotSlots[hashLockable(lockable)];
+  if (s.window.load(std::memory_order_relaxed) != now) {
+    s.window.store(now, std::memory_order_relaxed);
+    s.count.store(0, std::memory_order_relaxed);
+  }
+  return s.count.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+unsigned Galois::Runtime::conflictOwner(Lockable* lockable, unsigned num) {
+  return hashLockable(lockable) % num;
+}
+
 void Galois::Runtime::signalConflict(Lockable* lockable) {
+  lastConflict = lockable;
 #ifdef GALOIS_USE_LONGJMP
   if (releasableHead) releasableHead->releaseAll();
   longjmp(hackjmp, Galois::Runtime::CONFLICT);
@@ -149,16 +195,44 @@ void Galois::Runtime::SimpleRuntimeContext::acquire(Galois::Runtime::Lockable* l
   }
 }
 
+void Galois::Runtime::SimpleRuntimeContext::acquireRead(Galois::Runtime::Lockable* lockable) {
+  if (customAcquire || failsafe) {
+    acquire(lockable);
+    return;
+  }
+  // Read the version before the lock: a release in between changes the
+  // version, which validation catches
+  unsigned v = lockable->version.load(std::memory_order_acquire);
+  if (lockable->owner.is_locked()) {
+    if (getOwner(lockable) == this)
+      return;
+    Galois::Runtime::signalConflict(lockable);
+  }
+  reads.push_back(std::make_pair(lockable, v));
+}
+
+void Galois::Runtime::SimpleRuntimeContext::validateReads() {
+  for (auto& r : reads) {
+    Lockable* lockable = r.first;
+    if ((lockable->owner.is_locked() && getOwner(lockable) != this)
+        || lockable->version.load(std::memory_order_acquire) != r.second)
+      Galois::Runtime::signalConflict(lockable);
+  }
+}
+
 void Galois::Runtime::SimpleRuntimeContext::release(Galois::Runtime::Lockable* lockable) {
   assert(lockable);
   // The deterministic executor, for instance, steals locks from other
   // iterations
   assert(customAcquire || getOwner(lockable) == this);
   assert(!lockable->next);
+  lockable->version.fetch_add(1, std::memory_order_relaxed);
   lockable->owner.unlock_and_clear();
 }
 
 unsigned Galois::Runtime::SimpleRuntimeContext::commitIteration() {
+  reads.clear();
+  failsafe = false;
   unsigned numLocks = 0;
   while (locks) {
     //ORDER MATTERS!
@@ -22,9 +22,13 @@
  */
 
 #include "Galois/Runtime/PerThreadStorage.h"
+#include "Galois/Runtime/ll/CompilerSpecific.h"
+#include "Galois/Runtime/ll/HWTopo.h"
 #include "Galois/Runtime/ll/gio.h"
 #include "Galois/Runtime/mm/Mem.h"
 
+#include <algorithm>
+
 #include <sys/mman.h>
 
 #if defined(GALOIS_USE_NUMA) && !defined(GALOIS_FORCE_NO_NUMA)
@@ -32,6 +36,7 @@
 #endif
 
 #ifdef USE_NUMA
+#include <numa.h>
 #include <numaif.h>
 #endif
 
@@ -52,21 +57,55 @@ Galois::Runtime::PerBackend& Galois::Runtime::getPPSBackend() {
 #define MORE_MEM_HACK
 #ifdef MORE_MEM_HACK
 const size_t allocSize = Galois::Runtime::MM::pageSize * 128;
-inline void* alloc() {
-  void* p = mmap(0, allocSize, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE | MAP_HUGETLB, -1, 0);
-  if (p == MAP_FAILED) {
-    perror("mmap");
-    exit(1);
+
+//! Makes pages of the block of thread tid come from the node tid will be
+//! bound to. Blocks are initialized by the master thread, so first touch
+//! alone would put every block on the master's node.
+inline void placeOnHomeNode(void* p, unsigned tid) {
+#ifdef USE_NUMA
+  unsigned long mask = 0;
+  unsigned long* nodes = NULL;
+# ifndef GALOIS_USE_NUMA_OLD
+  int node = numa_available() < 0 ? -1 : numa_node_of_cpu(Galois::Runtime::LL::getProcessorForThread(tid));
+  if (node >= 0 && node < (int) sizeof(mask) * 8 - 1) {
+    mask = 1UL << node;
+    nodes = &mask;
   }
-  if (mbind(p, allocSize, MPOL_PREFERRED, NULL, 0, 0) < 0) {
+# endif
+  // Without a known node, prefer the node of the touching thread
+  if (mbind(p, allocSize, MPOL_PREFERRED, nodes, nodes ? sizeof(mask) * 8 : 0, 0) < 0) {
     perror("mbind");
     exit(1);
   }
+#endif
+}
+
+//! Maps a block aligned to and backed by huge pages where possible: first
+//! from the reserved pool, then transparently
+inline void* alloc(unsigned tid) {
+  void* p = mmap(0, allocSize, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE | MAP_HUGETLB, -1, 0);
+  if (p == MAP_FAILED) {
+    const size_t align = Galois::Runtime::MM::pageSize;
+    char* r = (char*) mmap(0, allocSize + align, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (r == MAP_FAILED) {
+      perror("mmap");
+      exit(1);
+    }
+    char* a = (char*) (((uintptr_t) r + align - 1) & ~(uintptr_t) (align - 1));
+    if (a != r)
+      munmap(r, a - r);
+    munmap(a + allocSize, r + align - a);
+#ifdef MADV_HUGEPAGE
+    madvise(a, allocSize, MADV_HUGEPAGE);
+#endif
+    p = a;
+  }
+  placeOnHomeNode(p, tid);
   return p;
 }
 #else
 const size_t allocSize = Galois::Runtime::MM::pageSize;
-inline void* alloc() {
+inline void* alloc(unsigned tid) {
   return Galois::Runtime::MM::pageAlloc();
 }
 #endif
@@ -87,10 +126,19 @@ unsigned Galois::Runtime::PerBackend::allocOffset(const unsigned sz) {
   unsigned retval = allocSize;
 
   unsigned size = (1 << nextLog2(sz));
+  // Align to the size, up to a cache line, so that members with alignment
+  // requirements (e.g., cache line storage) stay aligned
+  unsigned align = std::min(size, (unsigned) GALOIS_CACHE_LINE_SIZE);
 
-  if ((nextLoc + size) <= allocSize) {
+  unsigned loc, start;
+  do {
+    loc = nextLoc;
+    start = (loc + align - 1) & ~(align - 1);
+  } while (start + size <= allocSize && !__sync_bool_compare_and_swap(&nextLoc, loc, start + size));
+
+  if (start + size <= allocSize) {
     // simple path, where we allocate bump ptr style
-    retval = __sync_fetch_and_add (&nextLoc, size);
+    retval = start;
   } else {
     // find a free offset
     unsigned index = nextLog2(sz);
@@ -150,7 +198,8 @@ void Galois::Runtime::PerBackend::initCommon() {
 
 char* Galois::Runtime::PerBackend::initPerThread() {
   initCommon();
-  char* b = heads[LL::getTID()] = (char*) alloc();
+  unsigned id = LL::getTID();
+  char* b = heads[id] = (char*) alloc(id);
   return b;
 }
 
@@ -159,7 +208,7 @@ char* Galois::Runtime::PerBackend::initPerPackage() {
   unsigned id = LL::getTID();
   unsigned leader = LL::getLeaderForThread(id);
   if (id == leader) {
-    char* b = heads[id] = (char*) alloc();
+    char* b = heads[id] = (char*) alloc(id);
     memset(b, 0, allocSize);
     return b;
   } else {
@@ -23,6 +23,7 @@
 #include "Galois/Statistic.h"
 #include "Galois/Runtime/PerThreadStorage.h"
 #include "Galois/Runtime/Support.h"
+#include "Galois/Runtime/ll/EnvCheck.h"
 #include "Galois/Runtime/ll/StaticInstance.h"
 #include "Galois/Runtime/ll/gio.h"
 #include "Galois/Runtime/mm/Mem.h"
@@ -31,18 +32,39 @@
 #include <map>
 #include <vector>
 #include <string>
+#include <chrono>
 #include <cmath>
+#include <fstream>
+#include <limits>
 
 using Galois::Runtime::LL::gPrint;
 
 namespace {
 
+//! Escapes a string for a JSON string literal
+std::string quote(const std::string& s) {
+  std::string r = "\"";
+  for (char c : s) {
+    if (c == '"' || c == '\\')
+      r += '\\';
+    if ((unsigned char) c >= 0x20)
+      r += c;
+  }
+  return r + "\"";
+}
+
 class StatManager {
   typedef std::pair<std::string, std::string> KeyTy;
+  typedef std::vector<unsigned long> HistTy;
+  //! (microseconds since startup, value) pairs
+  typedef std::vector<std::pair<unsigned long, unsigned long> > SeriesTy;
 
   Galois::Runtime::PerThreadStorage<std::map<KeyTy, unsigned long> > Stats;
+  Galois::Runtime::PerThreadStorage<std::map<KeyTy, HistTy> > Hists;
+  Galois::Runtime::PerThreadStorage<std::map<KeyTy, SeriesTy> > Series;
 
   volatile unsigned maxID;
+  std::chrono::steady_clock::time_point startTime;
 
   void updateMax(unsigned n) {
     unsigned c;
@@ -67,8 +89,111 @@ class StatManager {
     return R;
   }
 
+  void addToHist(HistTy& h, const Galois::Log2Histogram& value) {
+    h.resize(Galois::Log2Histogram::NumBuckets);
+    for (unsigned i = 0; i < Galois::Log2Histogram::NumBuckets; ++i)
+      h[i] += value.counts[i];
+  }
+
+  template<typename T>
+  void gatherKeys(Galois::Runtime::PerThreadStorage<std::map<KeyTy, T> >& S, unsigned m, std::set<KeyTy>& keys) {
+    for (unsigned x = 0; x < m; ++x)
+      for (auto& kv : *S.getRemote(x))
+        keys.insert(kv.first);
+  }
+
+  void writeJSON(const std::string& name, unsigned m) {
+    std::ofstream out(name.c_str());
+    std::set<KeyTy> keys;
+    out << "{\n  \"threads\": " << m << ",\n  \"stats\": [";
+    gatherKeys(Stats, m, keys);
+    const char* sep = "\n";
+    for (const KeyTy& k : keys) {
+      std::vector<unsigned long> Values;
+      gather(k.first, k.second, m, Values);
+      out << sep << "    {\"loop\": " << quote(k.first) << ", \"category\": " << quote(k.second)
+          << ", \"sum\": " << getSum(Values, m) << ", \"values\": [";
+      for (unsigned x = 0; x < m; ++x)
+        out << (x ? ", " : "") << Values[x];
+      out << "]}";
+      sep = ",\n";
+    }
+    // Bucket 0 counts zeros, bucket i > 0 values in [2^(i-1), 2^i); trailing
+    // empty buckets are left out
+    out << "\n  ],\n  \"histograms\": [";
+    sep = "\n";
+    for (unsigned x = 0; x < m; ++x) {
+      for (auto& kv : *Hists.getRemote(x)) {
+        const HistTy& h = kv.second;
+        size_t n = h.size();
+        while (n && !h[n - 1])
+          --n;
+        out << sep << "    {\"loop\": " << quote(kv.first.first) << ", \"category\": " << quote(kv.first.second)
+            << ", \"thread\": " << x << ", \"counts\": [";
+        for (size_t i = 0; i < n; ++i)
+          out << (i ? ", " : "") << h[i];
+        out << "]}";
+        sep = ",\n";
+      }
+    }
+    out << "\n  ],\n  \"series\": [";
+    sep = "\n";
+    for (unsigned x = 0; x < m; ++x) {
+      for (auto& kv : *Series.getRemote(x)) {
+        out << sep << "    {\"loop\": " << quote(kv.first.first) << ", \"category\": " << quote(kv.first.second)
+            << ", \"thread\": " << x << ", \"samples\": [";
+        for (size_t i = 0; i < kv.second.size(); ++i)
+          out << (i ? ", " : "") << "[" << kv.second[i].first << ", " << kv.second[i].second << "]";
+        out << "]}";
+        sep = ",\n";
+      }
+    }
+    out << "\n  ]\n}\n";
+  }
+
+  void writeCSV(const std::string& prefix, unsigned m) {
+    std::set<KeyTy> keys;
+    gatherKeys(Stats, m, keys);
+    std::ofstream stats((prefix + "-stats.csv").c_str());
+    stats << "loop,category,thread,value\n";
+    for (const KeyTy& k : keys) {
+      std::vector<unsigned long> Values;
+      gather(k.first, k.second, m, Values);
+      for (unsigned x = 0; x < m; ++x)
+        stats << k.first << "," << k.second << "," << x << "," << Values[x] << "\n";
+    }
+
+    std::ofstream hists((prefix + "-histograms.csv").c_str());
+    hists << "loop,category,thread,low,high,count\n";
+    for (unsigned x = 0; x < m; ++x) {
+      for (auto& kv : *Hists.getRemote(x)) {
+        for (size_t i = 0; i < kv.second.size(); ++i) {
+          if (!kv.second[i])
+            continue;
+          unsigned long low = i ? 1UL << (i - 1) : 0;
+          unsigned long high = i ? (i < 64 ? (1UL << i) - 1 : std::numeric_limits<unsigned long>::max()) : 0;
+          hists << kv.first.first << "," << kv.first.second << "," << x << ","
+                << low << "," << high << "," << kv.second[i] << "\n";
+        }
+      }
+    }
+
+    std::ofstream series((prefix + "-series.csv").c_str());
+    series << "loop,category,thread,usec,value\n";
+    for (unsigned x = 0; x < m; ++x)
+      for (auto& kv : *Series.getRemote(x))
+        for (auto& s : kv.second)
+          series << kv.first.first << "," << kv.first.second << "," << x << ","
+                 << s.first << "," << s.second << "\n";
+  }
+
 public:
-  StatManager() :maxID(0) {}
+  StatManager() :maxID(0), startTime(std::chrono::steady_clock::now()) {}
+
+  unsigned long nowUsec() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - startTime).count();
+  }
 
   void addToStat(const std::string& loop, const std::string& category, size_t value) {
     (*Stats.getLocal())[mkKey(loop, category)] += value;
@@ -81,6 +206,22 @@ public:
     updateMax(Galois::Runtime::activeThreads);
   }
 
+  void addToHist(const std::string& loop, const std::string& category, const Galois::Log2Histogram& value) {
+    addToHist((*Hists.getLocal())[mkKey(loop, category)], value);
+    updateMax(Galois::Runtime::activeThreads);
+  }
+
+  void addToHist(Galois::Histogram* value) {
+    for (unsigned x = 0; x < Galois::Runtime::activeThreads; ++x)
+      addToHist((*Hists.getRemote(x))[mkKey(value->getLoopname(), value->getStatname())], value->getValue(x));
+    updateMax(Galois::Runtime::activeThreads);
+  }
+
+  void addSample(const std::string& loop, const std::string& category, unsigned long value) {
+    (*Series.getLocal())[mkKey(loop, category)].push_back(std::make_pair(nowUsec(), value));
+    updateMax(Galois::Runtime::activeThreads);
+  }
+
   void addPageAllocToStat(const std::string& loop, const std::string& category) {
     for (unsigned x = 0; x < Galois::Runtime::activeThreads; ++x)
       (*Stats.getRemote(x))[mkKey(loop, category)] += Galois::Runtime::MM::numPageAllocForThread(x);
@@ -126,6 +267,12 @@ public:
       }
       gPrint("\n");
     }
+
+    std::string prefix;
+    if (Galois::Runtime::LL::EnvCheck("GALOIS_STATS_OUT", prefix) && !prefix.empty()) {
+      writeJSON(prefix + ".json", maxThreadID);
+      writeCSV(prefix, maxThreadID);
+    }
   }
 };
 
@@ -149,6 +296,42 @@ void Galois::Runtime::reportStat(Galois::Statistic* value) {
   SM.get()->addToStat(value);
 }
 
+void Galois::Runtime::reportHistogram(const char* loopname, const char* category, const Galois::Log2Histogram& value) {
+  SM.get()->addToHist(std::string(loopname ? loopname : "(NULL)"),
+                      std::string(category ? category : "(NULL)"),
+                      value);
+}
+
+void Galois::Runtime::reportHistogram(Galois::Histogram* value) {
+  SM.get()->addToHist(value);
+}
+
+void Galois::Runtime::reportSample(const char* loopname, const char* category, unsigned long value) {
+  SM.get()->addSample(std::string(loopname ? loopname : "(NULL)"),
+                      std::string(category ? category : "(NULL)"),
+                      value);
+}
+
+static unsigned long sampleInterval() {
+  int usec;
+  if (Galois::Runtime::LL::EnvCheck("GALOIS_STATS_INTERVAL", usec) && usec > 0)
+    return usec;
+  return 0;
+}
+
+bool Galois::Runtime::sampleDue(unsigned long& next) {
+  static const unsigned long interval = sampleInterval();
+  if (!interval) {
+    next = std::numeric_limits<unsigned long>::max();
+    return false;
+  }
+  unsigned long now = SM.get()->nowUsec();
+  if (now < next)
+    return false;
+  next = now + interval;
+  return true;
+}
+
 void Galois::Runtime::printStats() {
   SM.get()->printStats();
 }
@@ -22,7 +22,8 @@
  *
  * @section Description
  *
- * Implementation of Dikstra dual-ring Termination Detection
+ * Implementation of Dikstra dual-ring Termination Detection and of
+ * pending work counting
  *
  * @author Andrew Lenharth <andrewl@lenharth.org>
  */
@@ -31,6 +32,8 @@
 #include "Galois/Runtime/Termination.h"
 #include "Galois/Runtime/ll/CompilerSpecific.h"
 
+#include <sched.h>
+
 using namespace Galois::Runtime;
 
 namespace {
@@ -246,3 +249,41 @@ Galois::Runtime::TerminationDetection& Galois::Runtime::getSystemTermination() {
   //return getTreeTermination();
 }
 
+
+void QuiescenceDetection::initializeThread() {
+  ThreadState& s = *state.getLocal();
+  s.delta = 0;
+  s.updates = 0;
+  s.backoff = 1;
+  s.idle = false;
+  globalTerm.data = false;
+  // Other threads only touch the word after the barrier that follows
+  if (LL::getTID() == 0)
+    word.data = Busy * activeThreads;
+}
+
+void QuiescenceDetection::localTermination(bool workHappened) {
+  if (workHappened)
+    return;
+  ThreadState& s = *state.getLocal();
+  if (!s.idle) {
+    s.idle = true;
+    fold(s, -Busy);
+  }
+  if (word.data.load() == 0) {
+    globalTerm.data = true;
+    return;
+  }
+  if (s.backoff < MaxBackoff) {
+    for (unsigned i = 0; i < s.backoff; ++i)
+      LL::asmPause();
+    s.backoff <<= 1;
+  } else {
+    sched_yield();
+  }
+}
+
+Galois::Runtime::QuiescenceDetection& Galois::Runtime::getQuiescenceTermination() {
+  static QuiescenceDetection term;
+  return term;
+}
@@ -22,6 +22,7 @@
  */
 #include "Galois/Runtime/Sampling.h"
 #include "Galois/Runtime/ThreadPool.h"
+#include "Galois/Runtime/ll/CompilerSpecific.h"
 #include "Galois/Runtime/ll/EnvCheck.h"
 #include "Galois/Runtime/ll/HWTopo.h"
 #include "Galois/Runtime/ll/TID.h"
@@ -29,6 +30,10 @@
 #include "boost/utility.hpp"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdint>
 #include <cstdlib>
 #include <cstdio>
 #include <cerrno>
@@ -36,6 +41,11 @@
 
 #include <semaphore.h>
 #include <pthread.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 // Forward declare this to avoid including PerThreadStorage.
 // We avoid this to stress that the thread Pool MUST NOT depend on PTS.
@@ -86,6 +96,17 @@ public:
   }
 };
 
+#ifdef __linux__
+//! Sleeps while *addr == val; may return spuriously
+static void futexWait(std::atomic<int>* addr, int val) {
+  syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, 0, 0, 0);
+}
+
+static void futexWakeAll(std::atomic<int>* addr) {
+  syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, INT_MAX, 0, 0, 0);
+}
+#endif
+
 class ThinBarrier: private boost::noncopyable {
   volatile int started;
 public:
@@ -99,6 +120,19 @@ public:
 };
 
 
+/**
+ * Idle workers wait for the next run call in one of two modes.
+ *
+ * By default, each worker sleeps on its own semaphore and run releases
+ * them along a binary tree (cascade).
+ *
+ * If GALOIS_POOL_SPIN is set to a number of microseconds (Linux only),
+ * run instead publishes a new generation, which carries the number of
+ * threads to start, with a single store. Idle workers spin on the
+ * generation for that long after finishing a loop and then park on a
+ * futex, which run only wakes if someone is parked. Back to back loops
+ * then start without any system call.
+ */
 class ThreadPool_pthread : public ThreadPool {
   pthread_t* threads; // Set of threads
   Semaphore* starts;  // Signal to release threads to run
@@ -108,6 +142,11 @@ class ThreadPool_pthread : public ThreadPool {
   volatile RunCommand* workBegin; // Begin iterator for work commands
   volatile RunCommand* workEnd; // End iterator for work commands
 
+  int spinUsec; // Negative if workers wait on semaphores
+  std::atomic<uint64_t> generation; // Run count << 32 | threads to run
+  std::atomic<int> wakeWord; // Futex parked workers wait on
+  std::atomic<unsigned> sleepers; // Workers parked or about to park
+
   void initThread() {
     // Initialize TID
     Galois::Runtime::LL::initTID();
@@ -131,7 +170,8 @@ class ThreadPool_pthread : public ThreadPool {
   }
 
   void doWork(unsigned tid) {
-    cascade(tid);
+    if (spinUsec < 0)
+      cascade(tid);
     RunCommand* workPtr = (RunCommand*)workBegin;
     RunCommand* workEndL = (RunCommand*)workEnd;
     prefixThreadWork(tid);
@@ -154,12 +194,58 @@ class ThreadPool_pthread : public ThreadPool {
 
   void launch() {
     unsigned tid = Galois::Runtime::LL::getTID();
+    if (spinUsec >= 0) {
+      uint64_t seen = 0;
+      while (!shutdown) {
+        seen = waitForGeneration(seen);
+        if (tid < (seen & 0xFFFFFFFF))
+          doWork(tid);
+      }
+      return;
+    }
     while (!shutdown) {
       starts[tid].acquire();
       doWork(tid);
     }
   }
 
+  uint64_t waitForGeneration(uint64_t seen) {
+    uint64_t g;
+    auto start = std::chrono::steady_clock::now();
+    const std::chrono::microseconds window(spinUsec);
+    for (unsigned i = 1; (g = generation.load(std::memory_order_acquire)) == seen; ++i) {
+      LL::asmPause();
+      if ((i & 1023) == 0 && std::chrono::steady_clock::now() - start > window)
+        break;
+    }
+    while ((g = generation.load(std::memory_order_acquire)) == seen)
+      park(seen);
+    return g;
+  }
+
+  void park(uint64_t seen) {
+#ifdef __linux__
+    // Pairs with the store, increment and load in publish: either run sees
+    // this sleeper or this thread sees the new generation
+    sleepers.fetch_add(1);
+    int w = wakeWord.load();
+    if (generation.load() == seen)
+      futexWait(&wakeWord, w);
+    sleepers.fetch_sub(1);
+#endif
+  }
+
+  //! Starts the first num threads in spinning mode
+  void publish(unsigned num) {
+    uint64_t g = ((generation.load(std::memory_order_relaxed) >> 32) + 1) << 32 | num;
+    generation.store(g);
+#ifdef __linux__
+    wakeWord.fetch_add(1);
+    if (sleepers.load())
+      futexWakeAll(&wakeWord);
+#endif
+  }
+
   static void* slaunch(void* V) {
     ThreadPool_pthread* TP = (ThreadPool_pthread*)V;
     TP->initThread();
@@ -170,8 +256,14 @@ class ThreadPool_pthread : public ThreadPool {
 public:
   ThreadPool_pthread():
     ThreadPool(Galois::Runtime::LL::getMaxThreads()),
-    started(0), shutdown(false), workBegin(0), workEnd(0)
+    started(0), shutdown(false), workBegin(0), workEnd(0),
+    spinUsec(-1), generation(0), wakeWord(0), sleepers(0)
   {
+#ifdef __linux__
+    int usec;
+    if (LL::EnvCheck("GALOIS_POOL_SPIN", usec))
+      spinUsec = std::max(usec, 0);
+#endif
     initThread();
 
     starts = new Semaphore[maxThreads];
@@ -188,8 +280,11 @@ public:
     shutdown = true;
     workBegin = workEnd = 0;
     __sync_synchronize();
-    for (unsigned i = 1; i < maxThreads; ++i)
-      starts[i].release();
+    if (spinUsec >= 0)
+      publish(maxThreads);
+    else
+      for (unsigned i = 1; i < maxThreads; ++i)
+        starts[i].release();
     for (unsigned i = 1; i < maxThreads; ++i) {
       int rc = pthread_join(threads[i], NULL);
       checkResults(rc);
@@ -208,6 +303,8 @@ public:
     workEnd = end;
     // Ensure stores happen before children are spawned
     __sync_synchronize();
+    if (spinUsec >= 0 && num > 1)
+      publish(num);
     // Do master thread work
     doWork(0);
     // Clean up
@@ -0,0 +1,94 @@
+/** Barrier Microbenchmark -*- C++ -*-
+ * @file
+ * @section License
+ *
+ * Galois, a framework to exploit amorphous data-parallelism in irregular
+ * programs.
+ *
+ * Copyright (C) 2013, The University of Texas at Austin. All rights reserved.
+ * UNIVERSITY EXPRESSLY DISCLAIMS ANY AND ALL WARRANTIES CONCERNING THIS
+ * SOFTWARE AND DOCUMENTATION, INCLUDING ANY WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR ANY PARTICULAR PURPOSE, NON-INFRINGEMENT AND WARRANTIES OF
+ * PERFORMANCE, AND ANY WARRANTY THAT MIGHT OTHERWISE ARISE FROM COURSE OF
+ * DEALING OR USAGE OF TRADE.  NO WARRANTY IS EITHER EXPRESS OR IMPLIED WITH
+ * RESPECT TO THE USE OF THE SOFTWARE OR DOCUMENTATION. Under no circumstances
+ * shall University be liable for incidental, special, indirect, direct or
+ * consequential damages or loss of profits, interruption of business, or
+ * related expenses which may arise from use of Software or Documentation,
+ * including but not limited to those resulting from defects in Software and/or
+ * Documentation, or loss or inaccuracy of data of any kind.
+ *
+ * @section Description
+ *
+ * Time per wait of each barrier type and check of fused reductions
+ */
+#include "Galois/Galois.h"
+#include "Galois/Runtime/Barrier.h"
+
+#include <chrono>
+#include <iostream>
+#include <cstdlib>
+
+unsigned iter = 16*1024;
+
+struct waiter {
+  Galois::Runtime::Barrier& b;
+  void operator()(unsigned tid, unsigned num) {
+    for (unsigned i = 0; i < iter; ++i)
+      b.wait();
+  }
+};
+
+struct reducer {
+  Galois::Runtime::Barrier& b;
+  void operator()(unsigned tid, unsigned num) {
+    for (unsigned i = 0; i < iter; ++i) {
+      typedef Galois::Runtime::Barrier B;
+      uint64_t v = tid + 1 + i;
+      uint64_t sum = b.reduce(v, B::SUM);
+      uint64_t mn = b.reduce(v, B::MIN);
+      uint64_t mx = b.reduce(v, B::MAX);
+      if (sum != (uint64_t) num * (num + 1) / 2 + (uint64_t) num * i || mn != 1 + i || mx != num + i) {
+        std::cerr << "bad reduction: " << sum << " " << mn << " " << mx << "\n";
+        abort();
+      }
+    }
+  }
+};
+
+double nsPer(std::chrono::steady_clock::time_point start, unsigned n) {
+  std::chrono::duration<double, std::nano> d = std::chrono::steady_clock::now() - start;
+  return d.count() / n;
+}
+
+void test(const char* name, Galois::Runtime::Barrier* b, bool reduces) {
+  unsigned M = Galois::Runtime::LL::getMaxThreads();
+
+  while (M) {
+    Galois::setActiveThreads(M);
+    b->reinit(M);
+
+    auto start = std::chrono::steady_clock::now();
+    Galois::on_each(waiter{*b});
+    std::cout << name << " " << M << " threads: " << nsPer(start, iter) << " ns/wait\n";
+
+    if (reduces) {
+      start = std::chrono::steady_clock::now();
+      Galois::on_each(reducer{*b});
+      std::cout << name << " " << M << " threads: " << nsPer(start, 3 * iter) << " ns/reduce\n";
+    }
+
+    M >>= 1;
+  }
+  delete b;
+}
+
+int main(int argc, char** argv) {
+  if (argc > 1)
+    iter = atoi(argv[1]);
+  test("pthread", Galois::Runtime::createSimpleBarrier(), false);
+  test("mcs", Galois::Runtime::createMCSBarrier(), false);
+  test("topo", Galois::Runtime::createTopoBarrier(), false);
+  test("hier", Galois::Runtime::createHierBarrier(), true);
+  return 0;
+}